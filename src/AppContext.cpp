@@ -7,15 +7,9 @@
 AppContext::~AppContext()
 {
     // --- Orphaned process cleanup ---
-    if (engine) { // engine is a new member of AppContext
-        for (ScriptRunner* runner : engine->get_running_scripts()) {
-            pid_t pid = runner->get_pid();
-            if (pid > 0) {
-                LOG_WARN("Killing orphaned script processes with PID: ", pid);
-                kill(-pid, SIGKILL);
-            }
-        }
-    }
+    // main() clears `engine` before the engine goes; ~ModEngine kills its
+    // scripts itself. This only catches an engine that is somehow still up.
+    if (engine) engine->kill_running_scripts();
 
     if (controller)
     {
@@ -28,5 +28,10 @@ struct AppContext {
 
     bool is_momw_config = false;
 
+    // Scanner tuning (0 = pick automatically / use the default)
+    int scan_workers = 0;
+    int scan_max_depth = 0;
+    long long scan_max_entries = 0;
+
     ~AppContext();
 };
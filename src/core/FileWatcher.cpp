@@ -0,0 +1,156 @@
+#include "FileWatcher.h"
+#include "../utils/Logger.h"
+#include <cerrno>
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// Structural changes are all the mod parser cares about. File contents only
+// matter for the archive marker file, which lives in the mod root.
+static const unsigned DIR_EVENTS = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                   IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+bool FileWatcher::start(const fs::path& archive_dir, const fs::path& mod_data_dir, const fs::path& cfg_path) {
+    stop();
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0) {
+        LOG_WARN("inotify unavailable (", std::strerror(errno), "), falling back to full rescans.");
+        return false;
+    }
+
+    m_mod_data_dir = mod_data_dir;
+    m_cfg_path = cfg_path;
+    m_cfg_filename = cfg_path.filename().string();
+
+    // Archives are only interesting once fully written, hence IN_CLOSE_WRITE.
+    add_watch(archive_dir, DIR_EVENTS | IN_CLOSE_WRITE, Kind::ARCHIVES);
+    add_watch(mod_data_dir, DIR_EVENTS, Kind::MOD_DATA);
+    // Watch the directory rather than the file: editors and our own writer
+    // replace openmw.cfg, which would orphan a watch on the file itself.
+    fs::path cfg_dir = cfg_path.has_parent_path() ? cfg_path.parent_path() : fs::path(".");
+    if (add_watch(cfg_dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE, Kind::CONFIG_DIR) < 0) {
+        stop();
+        return false;
+    }
+    LOG_DEBUG("Filesystem watcher started.");
+    return true;
+}
+
+void FileWatcher::stop() {
+    if (m_fd >= 0) close(m_fd);
+    m_fd = -1;
+    m_watches.clear();
+    m_mod_watches.clear();
+}
+
+int FileWatcher::add_watch(const fs::path& path, unsigned mask, Kind kind, const fs::path& mod_root) {
+    if (m_fd < 0) return -1;
+    int wd = inotify_add_watch(m_fd, path.c_str(), mask);
+    if (wd < 0) {
+        if (errno == ENOSPC) {
+            LOG_WARN("Out of inotify watches; raise fs.inotify.max_user_watches. Falling back to full rescans.");
+            stop();
+        } else {
+            LOG_DEBUG("Not watching ", path.string(), ": ", std::strerror(errno));
+        }
+        return -1;
+    }
+    // The kernel hands back the same descriptor for an inode that is already
+    // watched; the first role wins.
+    m_watches.emplace(wd, Watch{kind, path, mod_root});
+    return wd;
+}
+
+void FileWatcher::remove_watch(int wd) {
+    auto it = m_watches.find(wd);
+    if (it == m_watches.end()) return;
+    if (it->second.kind == Kind::MOD_DIR) inotify_rm_watch(m_fd, wd);
+    m_watches.erase(it);
+}
+
+void FileWatcher::set_mod_dirs(const fs::path& mod_root, const std::vector<fs::path>& dirs) {
+    if (m_fd < 0) return;
+    std::set<int> new_wds;
+    for (const auto& dir : dirs) {
+        int wd = add_watch(dir, DIR_EVENTS | IN_CLOSE_WRITE, Kind::MOD_DIR, mod_root);
+        if (m_fd < 0) return; // watcher gave up
+        if (wd >= 0) new_wds.insert(wd);
+    }
+    for (int wd : m_mod_watches[mod_root]) {
+        if (!new_wds.count(wd)) remove_watch(wd);
+    }
+    m_mod_watches[mod_root] = new_wds;
+}
+
+void FileWatcher::remove_mod(const fs::path& mod_root) {
+    auto it = m_mod_watches.find(mod_root);
+    if (it == m_mod_watches.end()) return;
+    for (int wd : it->second) remove_watch(wd);
+    m_mod_watches.erase(it);
+}
+
+void FileWatcher::retain_mods(const std::set<fs::path>& mod_roots) {
+    std::vector<fs::path> stale;
+    for (const auto& pair : m_mod_watches) {
+        if (!mod_roots.count(pair.first)) stale.push_back(pair.first);
+    }
+    for (const auto& root : stale) remove_mod(root);
+}
+
+FsChangeSet FileWatcher::poll() {
+    FsChangeSet changes;
+    if (m_fd < 0) return changes;
+
+    alignas(struct inotify_event) char buffer[16 * 1024];
+    for (;;) {
+        ssize_t len = read(m_fd, buffer, sizeof(buffer));
+        if (len <= 0) break; // EAGAIN: drained
+
+        for (char* ptr = buffer; ptr < buffer + len;) {
+            auto* event = reinterpret_cast<struct inotify_event*>(ptr);
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                changes.overflowed = true;
+                continue;
+            }
+
+            auto it = m_watches.find(event->wd);
+            if (it == m_watches.end()) continue;
+            const Watch watch = it->second;
+            std::string name = event->len ? event->name : "";
+
+            if (event->mask & IN_IGNORED) {
+                // Directory went away; the kernel already dropped the watch.
+                m_watches.erase(it);
+                if (watch.kind == Kind::MOD_DIR) {
+                    m_mod_watches[watch.mod_root].erase(event->wd);
+                    changes.mod_roots.insert(watch.mod_root);
+                }
+                continue;
+            }
+
+            switch (watch.kind) {
+                case Kind::ARCHIVES:
+                    if (!name.empty()) changes.archives.insert(watch.path / name);
+                    break;
+                case Kind::MOD_DATA:
+                    if (!name.empty()) changes.mod_roots.insert(watch.path / name);
+                    break;
+                case Kind::CONFIG_DIR:
+                    if (name == m_cfg_filename) changes.config_changed = true;
+                    break;
+                case Kind::MOD_DIR:
+                    changes.mod_roots.insert(watch.mod_root);
+                    break;
+            }
+        }
+    }
+
+    if (changes.overflowed) LOG_WARN("inotify queue overflowed, a full rescan is required.");
+    return changes;
+}
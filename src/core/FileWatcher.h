@@ -0,0 +1,63 @@
+#pragma once
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+// Everything that changed on disk since the last poll, already mapped onto the
+// things ESMM derives from it.
+struct FsChangeSet {
+    std::set<fs::path> archives;   // archive files created, rewritten or removed
+    std::set<fs::path> mod_roots;  // mods whose directory tree changed (or appeared/vanished)
+    bool config_changed = false;   // openmw.cfg was written or replaced
+    bool overflowed = false;       // events were lost; caller must fall back to a full rescan
+
+    bool empty() const { return archives.empty() && mod_roots.empty() && !config_changed && !overflowed; }
+};
+
+// Thin inotify wrapper that watches the archive folder, the mod_data folder,
+// the directories each parsed mod depends on, and openmw.cfg.
+class FileWatcher {
+public:
+    FileWatcher() = default;
+    ~FileWatcher();
+
+    bool start(const fs::path& archive_dir, const fs::path& mod_data_dir, const fs::path& cfg_path);
+    void stop();
+    bool is_active() const { return m_fd >= 0; }
+
+    // Replaces the set of directories watched on behalf of `mod_root`.
+    void set_mod_dirs(const fs::path& mod_root, const std::vector<fs::path>& dirs);
+    void remove_mod(const fs::path& mod_root);
+    // Stops watching every mod not listed in `mod_roots`.
+    void retain_mods(const std::set<fs::path>& mod_roots);
+
+    // Drains pending events without blocking.
+    FsChangeSet poll();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+private:
+    enum class Kind { ARCHIVES, MOD_DATA, CONFIG_DIR, MOD_DIR };
+    struct Watch {
+        Kind kind;
+        fs::path path;
+        fs::path mod_root; // only for MOD_DIR
+    };
+
+    int add_watch(const fs::path& path, unsigned mask, Kind kind, const fs::path& mod_root = fs::path());
+    void remove_watch(int wd);
+
+    int m_fd = -1;
+    fs::path m_mod_data_dir;
+    std::string m_cfg_filename;
+    fs::path m_cfg_path;
+
+    std::unordered_map<int, Watch> m_watches;
+    std::map<fs::path, std::set<int>> m_mod_watches;
+};
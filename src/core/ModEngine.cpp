@@ -1,52 +1,83 @@
 #include "ModEngine.h"
 #include "StateMachine.h"
 #include "../mod/ConfigParser.h"
+#include "../mod/ContentSorter.h"
+#include "../mod/PluginCleaner.h"
 #include "../scenes/ScriptRunner.h"
 #include "../scenes/ScriptRunnerScene.h"
 #include "../scenes/AlertScene.h"
 #include "../utils/Logger.h"
 #include "../utils/Utils.h"
+#include "../utils/DirListing.h"
+#include "../utils/PathTrie.h"
+#include "../utils/StatCache.h"
 #include <set>
 #include <vector>
 #include <algorithm>
 #include <map>
 #include <fstream>
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
 
-// Helper to find the common base path for a list of paths
+// Helper to find the common base path for a list of paths: the deepest
+// directory that is a strict ancestor of all of them.
 static fs::path find_common_base(const std::vector<fs::path>& paths) {
     if (paths.empty()) return "";
-    if (paths.size() == 1) return paths[0].parent_path();
-
-    fs::path common_path = paths[0].parent_path();
-    for (size_t i = 1; i < paths.size(); ++i) {
-        // while path[i] is not a descendant of common_path
-        while (paths[i].string().find(common_path.string()) != 0 || paths[i] == common_path) {
-            if (common_path.has_parent_path()) {
-                common_path = common_path.parent_path();
-            } else {
-                return ""; // No common base found
-            }
-        }
-    }
+    PathTrie<char> trie;
+    for (const auto& p : paths) trie.insert(p, 1);
+    fs::path common_path = trie.common_prefix();
+    // Stopped on one of the paths themselves; its parent is the base.
+    if (trie.find(common_path)) common_path = common_path.parent_path();
     return common_path;
 }
 
+static void sort_mod_definitions(std::vector<ModDefinition>& mods) {
+    std::stable_sort(mods.begin(), mods.end(),
+        [](const ModDefinition& a, const ModDefinition& b) {
+            if (a.name == "The Elder Scrolls III: Morrowind") return true;
+            if (b.name == "The Elder Scrolls III: Morrowind") return false;
+            return a.name < b.name;
+        });
+}
+
 ModEngine::ModEngine(AppContext& ctx) : m_app_context(ctx) {}
 
 StateMachine& ModEngine::get_state_machine() { return *m_state_machine; }
 void ModEngine::set_state_machine(StateMachine& machine) { m_state_machine = &machine; }
 
-void ModEngine::discover_mod_definitions() {
+// Removes `path` like fs::remove_all, but one entry at a time so a
+// cancellation is noticed between files. Returns false if it stopped early.
+static bool remove_tree(const fs::path& path, const CancelToken& cancel, ProgressSink* progress) {
+    boost::system::error_code ec;
+    fs::file_status status = fs::symlink_status(path, ec);
+    if (ec) return true;
+    if (fs::is_directory(status)) {
+        std::vector<fs::path> children;
+        for (fs::directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+            children.push_back(it->path());
+        }
+        for (const auto& child : children) {
+            if (cancel.is_cancelled() || !remove_tree(child, cancel, progress)) return false;
+        }
+    }
+    fs::remove(path, ec);
+    if (ec) LOG_WARN("Could not remove ", path.string(), ": ", ec.message());
+    if (progress) progress->advance();
+    return true;
+}
+
+void ModEngine::discover_mod_definitions(const CancelToken& cancel, ProgressSink* progress) {
     // This method contains the core logic for finding and parsing mod directories.
     const auto& loaded_cfg = m_config_manager.get_loaded_data();
 
-    m_mod_manager.mod_definitions.clear();
+    std::vector<ModDefinition> mods;
     std::vector<fs::path> all_data_paths = loaded_cfg.data_paths;
     
     fs::path game_data_path;
     all_data_paths.erase(std::remove_if(all_data_paths.begin(), all_data_paths.end(),
         [&](const fs::path& p) {
-            if (fs::exists(p / "Morrowind.esm")) {
+            if (StatCache::instance().exists(p / "Morrowind.esm")) {
                 game_data_path = p;
                 return true;
             }
@@ -54,7 +85,7 @@ void ModEngine::discover_mod_definitions() {
         }), all_data_paths.end());
 
     m_mod_source_dirs.clear();
-    if (fs::exists(m_app_context.path_mod_data)) {
+    if (StatCache::instance().exists(m_app_context.path_mod_data)) {
         m_mod_source_dirs.push_back(m_app_context.path_mod_data);
     }
     std::vector<fs::path> external_paths;
@@ -64,36 +95,105 @@ void ModEngine::discover_mod_definitions() {
         }
     }
     if (!external_paths.empty()) {
-        m_mod_source_dirs.push_back(find_common_base(external_paths));
+        fs::path base = find_common_base(external_paths);
+        // A base at or right below the filesystem root would make whole system
+        // directories into "mods"; fall back to each path's own parent.
+        if (std::distance(base.begin(), base.end()) < 3) {
+            LOG_WARN("External data paths share no specific parent (", base.string(), "); scanning their parents individually.");
+            std::set<fs::path> parents;
+            for (const auto& p : external_paths) parents.insert(p.parent_path());
+            m_mod_source_dirs.insert(m_mod_source_dirs.end(), parents.begin(), parents.end());
+        } else {
+            m_mod_source_dirs.push_back(base);
+        }
     }
     
-    if (fs::exists(m_app_context.path_mod_data)) {
-        for (const auto& entry : fs::directory_iterator(m_app_context.path_mod_data)) {
-            if (fs::is_directory(entry)) all_data_paths.push_back(entry.path());
+    DirListing mod_data_listing;
+    if (read_directory(m_app_context.path_mod_data, mod_data_listing)) {
+        for (const auto& entry : mod_data_listing.entries) {
+            if (entry.type == DirEntry::DIRECTORY) all_data_paths.push_back(m_app_context.path_mod_data / entry.name);
         }
     }
 
+    // Each data path belongs to the mod named by its first component below the
+    // nearest source dir.
+    PathTrie<size_t> source_dirs;
+    for (size_t i = 0; i < m_mod_source_dirs.size(); ++i) {
+        if (!m_mod_source_dirs[i].empty()) source_dirs.insert(m_mod_source_dirs[i], i);
+    }
     std::map<fs::path, std::vector<fs::path>> grouped_paths;
     for (const auto& path : all_data_paths) {
-        fs::path mod_root;
-        for (const auto& source_dir : m_mod_source_dirs) {
-            if (!source_dir.empty() && path.string().find(source_dir.string()) == 0) {
-                fs::path relative = path.lexically_relative(source_dir);
-                if (!relative.empty() && relative.string() != ".") {
-                    mod_root = source_dir / *relative.begin();
-                    break;
-                }
-            }
+        fs::path source_dir;
+        if (!source_dirs.find_owner(path, &source_dir)) continue;
+        fs::path relative = path.lexically_relative(source_dir);
+        if (!relative.empty() && relative.string() != ".") {
+            grouped_paths[source_dir / *relative.begin()].push_back(path);
         }
-        if (!mod_root.empty()) grouped_paths[mod_root].push_back(path);
     }
     
+    // Reuse cached definitions for untouched mods; only re-parse what changed.
+    std::vector<fs::path> roots;
+    std::set<fs::path> seen_roots;
     for (const auto& pair : grouped_paths) {
-        if (fs::exists(pair.first)) {
-            m_mod_manager.mod_definitions.push_back(parse_mod_directory(pair.first));
+        struct stat st;
+        if (!stat_path(pair.first, st)) continue;
+        roots.push_back(pair.first);
+        seen_roots.insert(pair.first);
+    }
+
+    std::vector<ModDefinition> parsed(roots.size());
+    std::vector<std::vector<ListedDir>> listed_dirs(roots.size());
+    std::vector<ModScanStats> scan_stats(roots.size());
+    std::vector<char> needs_parse(roots.size(), 0);
+    std::vector<size_t> to_parse;
+    for (size_t i = 0; i < roots.size(); ++i) {
+        scan_stats[i].root = roots[i];
+        if (m_scan_index.lookup(roots[i], parsed[i])) {
+            scan_stats[i].cached = true;
+        } else {
+            needs_parse[i] = 1;
+            to_parse.push_back(i);
         }
     }
 
+    // Each mod is independent, latency-bound filesystem work; fan it out.
+    ModScanLimits limits = get_scan_limits();
+    limits.cancel = cancel;
+    if (progress) progress->begin("Scanning mods", to_parse.size());
+    get_worker_pool().parallel_for(to_parse.size(), [&](size_t n) {
+        size_t i = to_parse[n];
+        if (cancel.is_cancelled()) {
+            needs_parse[i] = 2;
+            return;
+        }
+        try {
+            parsed[i] = parse_mod_directory(roots[i], &listed_dirs[i], nullptr, &limits, &scan_stats[i]);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Error parsing mod ", roots[i].string(), ": ", e.what());
+            needs_parse[i] = 2;
+        }
+        if (progress) progress->advance();
+    });
+
+    // Merge back in the deterministic grouped_paths order. Truncated results
+    // depend on the budgets, so they are never cached.
+    for (size_t i = 0; i < roots.size(); ++i) {
+        if (needs_parse[i] == 2) continue;
+        if (needs_parse[i] == 1 && !scan_stats[i].truncated) m_scan_index.store(roots[i], parsed[i], listed_dirs[i]);
+        mods.push_back(std::move(parsed[i]));
+    }
+    // Mods that finished are cached above, so the next rescan picks up
+    // where a cancelled one stopped.
+    cancel.throw_if_cancelled();
+    LOG_INFO("Mod discovery: ", roots.size() - to_parse.size(), " cached, ", to_parse.size(), " parsed.");
+    m_scan_stats = std::move(scan_stats);
+    log_scan_stats();
+
+    m_scan_index.retain_only(seen_roots);
+    if (m_scan_index.is_dirty()) {
+        m_scan_index.save(m_app_context.path_config_dir / "openmw_esmm_scan.idx");
+    }
+
     if (!game_data_path.empty()) {
         ModDefinition mw_mod;
         mw_mod.name = "The Elder Scrolls III: Morrowind";
@@ -107,62 +207,63 @@ void ModEngine::discover_mod_definitions() {
         main_option.name = "Data Files";
         main_option.path = game_data_path;
         main_option.enabled = true;
-        main_option.parent_group = &main_group;
         main_option.discovered_plugins = find_plugins_in_path(game_data_path);
         main_group.options.push_back(main_option);
         mw_mod.option_groups.push_back(main_group);
-        m_mod_manager.mod_definitions.insert(m_mod_manager.mod_definitions.begin(), mw_mod);
+        mods.insert(mods.begin(), std::move(mw_mod));
     }
     
-    std::sort(m_mod_manager.mod_definitions.begin(), m_mod_manager.mod_definitions.end(),
-        [](const ModDefinition& a, const ModDefinition& b) {
-            if (a.name == "The Elder Scrolls III: Morrowind") return true;
-            if (b.name == "The Elder Scrolls III: Morrowind") return false;
-            return a.name < b.name;
-        });
+    sort_mod_definitions(mods);
+    m_mod_manager.set_mods(mods);
+    ++m_generations.mods;
+    publish_snapshot();
+    update_mod_watches();
 }
 
 
-void ModEngine::rescan_mods() {
-    LOG_INFO("Rescanning installed mods...");
-    discover_mod_definitions();
-    m_mod_manager.sync_ui_state_from_active_lists();
-    LOG_INFO("Mod rescan complete.");
+TaskScheduler& ModEngine::get_scheduler() {
+    std::call_once(m_scheduler_once, [this]() {
+        // --scan-workers only sets how wide scans fan out; the scheduler is
+        // sized on its own and always keeps a worker back for the UI.
+        unsigned width = WorkerPool::resolve_worker_count(m_app_context.scan_workers);
+        unsigned bulk = std::max(width, WorkerPool::resolve_worker_count(0));
+        m_scheduler = std::make_unique<TaskScheduler>(bulk);
+        m_worker_pool = std::make_unique<WorkerPool>(*m_scheduler, TaskScheduler::BULK, width);
+        LOG_DEBUG("Started task scheduler with ", m_scheduler->size(), " workers (", m_scheduler->bulk_limit(),
+                  " for bulk work), scanning ", width, " wide.");
+    });
+    return *m_scheduler;
 }
 
-void ModEngine::initialize() {
-    if (m_is_initialized) return;
-    LOG_INFO("ModEngine: Initializing...");
+WorkerPool& ModEngine::get_worker_pool() {
+    get_scheduler();
+    return *m_worker_pool;
+}
 
-    // --- MOMW check ---
-    std::ifstream cfg_file_check(m_app_context.path_openmw_cfg.string());
-    if (cfg_file_check.is_open()) {
-        std::string line;
-        for (int i = 0; i < 10 && std::getline(cfg_file_check, line); ++i) {
-            if (line.find("GENERATED WITH MOMW CONFIGURATOR") != std::string::npos) {
-                m_app_context.is_momw_config = true;
-                LOG_WARN("MOMW-generated openmw.cfg detected. Mod management features will be disabled.");
-                break;
-            }
-        }
-        cfg_file_check.close();
-    }
+void ModEngine::rescan_mods(const CancelToken& cancel, ProgressSink* progress) {
+    LOG_INFO("Rescanning installed mods...");
+    StatCache::instance().invalidate_all();
+    FsCounters before = fs_counters_snapshot();
+    drop_stale_cleaned_plugins();
+    discover_mod_definitions(cancel, progress);
+    m_mod_manager.sync_ui_state_from_active_lists();
+    publish_snapshot();
+    index_plugin_headers(collect_plugin_header_paths(), cancel, progress);
+    FsCounters used = fs_counters_snapshot() - before;
+    LOG_INFO("Mod rescan complete (", used.opens, " opens, ", used.getdents, " getdents, ", used.stats, " stats).");
+}
 
-    // 1. Load support systems and initial config
-    m_script_manager.scan_scripts(m_app_context.path_config_dir / "scripts");
-    m_script_manager.load_options(m_app_context.path_config_dir / "openmw_esmm_options.cfg");
-    m_config_manager.load(m_app_context.path_openmw_cfg);
-    
+void ModEngine::load_active_lists_from_config() {
     const auto& loaded_cfg = m_config_manager.get_loaded_data();
     m_mod_manager.active_data_paths = loaded_cfg.data_paths;
     m_mod_manager.active_content_files = loaded_cfg.content_files;
 
-    // --- PRUNING & DISCOVERY LOGIC ON STARTUP ---
+    // --- PRUNING & DISCOVERY LOGIC ---
     // A. Prune data paths that no longer exist.
     m_mod_manager.active_data_paths.erase(
         std::remove_if(m_mod_manager.active_data_paths.begin(), m_mod_manager.active_data_paths.end(),
             [](const fs::path& p) {
-                if (!fs::exists(p)) {
+                if (!StatCache::instance().exists(p)) {
                     LOG_WARN("Pruning missing data path: ", p.string());
                     return true;
                 }
@@ -171,18 +272,23 @@ void ModEngine::initialize() {
         m_mod_manager.active_data_paths.end());
 
     // B. Build a set of all plugins that are currently available in the (now-pruned) data paths.
-    std::set<std::string> available_plugins;
+    // The plugin index only lists data paths it hasn't seen before.
+    PluginIndex& plugin_index = m_mod_manager.plugin_index;
+    plugin_index.set_active_paths(m_mod_manager.active_data_paths);
+    std::unordered_set<StringId> seen_plugins;
+    std::vector<StringId> available_in_order;
     for (const auto& p : m_mod_manager.active_data_paths) {
-        auto plugins_in_path = find_plugins_in_path(p);
-        available_plugins.insert(plugins_in_path.begin(), plugins_in_path.end());
+        for (StringId id : plugin_index.plugins_in(intern(p.string()))) {
+            if (seen_plugins.insert(id).second) available_in_order.push_back(id);
+        }
     }
 
     // C. Prune content files that can no longer be found.
     m_mod_manager.active_content_files.erase(
         std::remove_if(m_mod_manager.active_content_files.begin(), m_mod_manager.active_content_files.end(),
             [&](const ContentFile& cf) {
-                if (available_plugins.find(cf.name) == available_plugins.end()) {
-                    LOG_WARN("Pruning missing content file: ", cf.name);
+                if (!plugin_index.is_available(cf.name)) {
+                    LOG_WARN("Pruning missing content file: ", interned(cf.name));
                     return true;
                 }
                 return false;
@@ -190,49 +296,199 @@ void ModEngine::initialize() {
         m_mod_manager.active_content_files.end());
 
     // D. Discover any new plugins in the data paths that aren't in the content list yet.
-    std::set<std::string> existing_plugins;
+    std::unordered_set<StringId> existing_plugins;
     for(const auto& cf : m_mod_manager.active_content_files) {
         existing_plugins.insert(cf.name);
     }
-    for(const auto& plugin_name : available_plugins) {
-        if(existing_plugins.find(plugin_name) == existing_plugins.end()) {
-            LOG_INFO("Discovered new plugin on startup: ", plugin_name);
+    std::sort(available_in_order.begin(), available_in_order.end(),
+              [](StringId a, StringId b) { return interned(a) < interned(b); });
+    const StringId unknown = intern("Unknown");
+    for(StringId plugin : available_in_order) {
+        if(existing_plugins.find(plugin) == existing_plugins.end()) {
+            LOG_INFO("Discovered new plugin: ", interned(plugin));
             ContentFile new_file;
-            new_file.name = plugin_name;
+            new_file.name = plugin;
             new_file.enabled = false;   // Add as disabled
-            new_file.source_mod = "Unknown"; // Source will be updated below
+            new_file.source_mod = unknown; // Source will be updated below
             new_file.is_new = true;
             m_mod_manager.active_content_files.push_back(new_file);
         }
     }
     // --- END PRUNING & DISCOVERY ---
+    m_mod_manager.invalidate_active_lists();
+    ++m_generations.active_lists;
+    m_saved_active_lists = m_generations.active_lists;
+    publish_snapshot();
+}
 
-    // 2. Discover all mod definitions from the filesystem.
-    discover_mod_definitions();
-    
-    // 3. Update source mod info for all content files.
-    std::map<std::string, std::string> all_plugins_map;
-    for(const auto& mod : m_mod_manager.mod_definitions) {
-        for(const auto& group : mod.option_groups) for(const auto& option : group.options) for(const auto& plugin : option.discovered_plugins) {
-            all_plugins_map[plugin] = mod.name;
-        }
+void ModEngine::touch_active_lists() {
+    ++m_generations.active_lists;
+    publish_snapshot();
+}
+
+static bool same_content_files(const std::vector<ContentFile>& a, const std::vector<ContentFile>& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const ContentFile& x, const ContentFile& y) {
+        return x.name == y.name && x.enabled == y.enabled && x.source_mod == y.source_mod && x.is_new == y.is_new;
+    });
+}
+
+void ModEngine::publish_snapshot() {
+    // Only this thread publishes, so the previous snapshot is ours to compare with.
+    std::shared_ptr<const EngineSnapshot> previous = std::atomic_load(&m_snapshot);
+    auto snapshot = std::make_shared<EngineSnapshot>(*previous);
+    snapshot->generations = m_generations;
+    if (previous->generations.mods != m_generations.mods) {
+        snapshot->mods = std::make_shared<const ModStore>(m_mod_manager.mod_store);
+    }
+    if (*previous->data_paths != m_mod_manager.active_data_paths) {
+        snapshot->data_paths = std::make_shared<const std::vector<fs::path>>(m_mod_manager.active_data_paths);
+    }
+    if (!same_content_files(*previous->content_files, m_mod_manager.active_content_files)) {
+        snapshot->content_files = std::make_shared<const std::vector<ContentFile>>(m_mod_manager.active_content_files);
     }
+    std::atomic_store(&m_snapshot, std::shared_ptr<const EngineSnapshot>(std::move(snapshot)));
+}
+
+std::unordered_map<StringId, StringId> ModEngine::collect_content_sources() const {
+    std::unordered_map<StringId, StringId> sources;
+    const PluginIndex& plugin_index = m_mod_manager.plugin_index;
+    for (const auto& cf : m_mod_manager.active_content_files) {
+        StringId source = plugin_index.source_mod(cf.name);
+        if (source != StringPool::EMPTY) sources[cf.name] = source;
+    }
+    return sources;
+}
+
+void ModEngine::apply_content_sources(const std::unordered_map<StringId, StringId>& sources) {
     for (auto& cf : m_mod_manager.active_content_files) {
-        if (all_plugins_map.count(cf.name)) {
-            cf.source_mod = all_plugins_map[cf.name];
+        auto it = sources.find(cf.name);
+        if (it != sources.end()) cf.source_mod = it->second;
+    }
+}
+
+const char* init_phase_name(InitPhase phase) {
+    switch (phase) {
+        case InitPhase::SCRIPTS:       return "Loading scripts";
+        case InitPhase::CONFIG:        return "Reading openmw.cfg";
+        case InitPhase::CONTENT_LISTS: return "Checking data paths and plugins";
+        case InitPhase::MODS:          return "Scanning mods";
+        case InitPhase::ARCHIVES:      return "Scanning archives";
+        case InitPhase::PLUGIN_HEADERS: return "Reading plugin headers";
+        case InitPhase::READY:         return "Ready";
+    }
+    return "";
+}
+
+ModEngine::~ModEngine() {
+    wait_for_initialization();
+    if (m_operation_task) {
+        m_operation_cancel.cancel();
+        m_scheduler->wait(m_operation_task);
+    }
+    // Otherwise joining the scheduler waits for each script to end on its own.
+    kill_running_scripts();
+}
+
+bool ModEngine::start_operation(const std::string& label, Operation op) {
+    if (m_operation_task) return false;
+    m_operation_label = label;
+    m_operation_cancel = CancelToken::make();
+    m_operation_progress.begin(label);
+
+    TaskScheduler& scheduler = get_scheduler();
+    CancelToken cancel = m_operation_cancel;
+    m_operation_task = scheduler.submit([this, label, cancel, op]() {
+        LOG_INFO(label, "...");
+        try {
+            op(cancel, m_operation_progress);
+        } catch (const OperationCancelled&) {
+            LOG_INFO(label, " cancelled.");
+        } catch (const std::exception& e) {
+            LOG_ERROR(label, " failed: ", e.what());
         }
+    }, TaskScheduler::INTERACTIVE); // someone is watching the progress bar
+    // Cleared on the main loop, so the UI only sees the engine again between frames.
+    scheduler.then_on_main(m_operation_task, [this]() { m_operation_task.reset(); });
+    return true;
+}
+
+void ModEngine::start_initialization() {
+    if (m_init_task || m_is_initialized) return;
+    m_init_task = get_scheduler().submit([this]() {
+        try {
+            initialize();
+        } catch (const std::exception& e) {
+            LOG_ERROR("ModEngine: Initialization failed: ", e.what());
+            {
+                std::lock_guard<std::mutex> lock(m_init_error_mutex);
+                m_init_error = e.what();
+            }
+            set_init_phase(InitPhase::READY);
+        }
+    }, TaskScheduler::INTERACTIVE); // the loading screen is waiting on it
+}
+
+void ModEngine::wait_for_initialization() {
+    if (!m_init_task) return;
+    m_scheduler->wait(m_init_task);
+    m_init_task.reset();
+}
+
+std::string ModEngine::get_init_error() const {
+    std::lock_guard<std::mutex> lock(m_init_error_mutex);
+    return m_init_error;
+}
+
+void ModEngine::set_init_phase(InitPhase phase) {
+    auto now = std::chrono::steady_clock::now();
+    InitPhase finished = m_init_phase.load();
+    if (finished != InitPhase::READY) {
+        LOG_DEBUG("ModEngine: ", init_phase_name(finished), " took ",
+                  std::chrono::duration_cast<std::chrono::milliseconds>(now - m_phase_start).count(), " ms.");
     }
+    m_phase_start = now;
+    m_init_phase.store(phase);
+}
 
-    // 4. Sync the UI state (checkboxes) based on the final, correct lists.
-    m_mod_manager.sync_ui_state_from_active_lists();
+void ModEngine::initialize() {
+    if (m_is_initialized) return;
+    LOG_INFO("ModEngine: Initializing...");
+    m_phase_start = std::chrono::steady_clock::now();
+
+    // 1. Load support systems
+    set_init_phase(InitPhase::SCRIPTS);
+    m_script_manager.scan_scripts(m_app_context.path_config_dir / "scripts");
+    m_script_manager.load_options(m_app_context.path_config_dir / "openmw_esmm_options.cfg");
+
+    // 2. Initial config. Once this is done the main menu is usable.
+    set_init_phase(InitPhase::CONFIG);
+    // --- MOMW check ---
+    std::ifstream cfg_file_check(m_app_context.path_openmw_cfg.string());
+    if (cfg_file_check.is_open()) {
+        std::string line;
+        for (int i = 0; i < 10 && std::getline(cfg_file_check, line); ++i) {
+            if (line.find("GENERATED WITH MOMW CONFIGURATOR") != std::string::npos) {
+                m_app_context.is_momw_config = true;
+                LOG_WARN("MOMW-generated openmw.cfg detected. Mod management features will be disabled.");
+                break;
+            }
+        }
+        cfg_file_check.close();
+    }
+    m_scan_index.load(m_app_context.path_config_dir / "openmw_esmm_scan.idx");
+    m_plugin_headers.load(m_app_context.path_config_dir / "openmw_esmm_headers.idx");
+    m_config_manager.load(m_app_context.path_openmw_cfg);
+    ++m_generations.config;
 
-    // 5. Scan archives and perform initial sort
-    m_archive_manager.scan_archives(m_app_context.path_mod_archives, m_app_context.path_mod_data);
+    // 3. Final data path and content lists. Scripts that write a temporary
+    // openmw.cfg only need this far.
+    set_init_phase(InitPhase::CONTENT_LISTS);
+    load_active_lists_from_config();
     LOG_INFO("Performing initial sort of core game files...");
 
     auto& data_paths = m_mod_manager.active_data_paths;
     auto it_data = std::find_if(data_paths.begin(), data_paths.end(), [](const fs::path& p) {
-        return fs::exists(p / "Morrowind.esm");
+        return StatCache::instance().exists(p / "Morrowind.esm");
     });
     if (it_data != data_paths.end() && it_data != data_paths.begin()) {
         fs::path gdp = *it_data;
@@ -241,8 +497,8 @@ void ModEngine::initialize() {
     }
 
     auto& content_files = m_mod_manager.active_content_files;
-    const std::vector<std::string> masters = {"Bloodmoon.esm", "Tribunal.esm", "Morrowind.esm"};
-    for (const auto& master_name : masters) {
+    const std::vector<StringId> masters = {intern("Bloodmoon.esm"), intern("Tribunal.esm"), intern("Morrowind.esm")};
+    for (StringId master_name : masters) {
         auto it_content = std::find_if(content_files.begin(), content_files.end(), [&](const ContentFile& cf){
             return cf.name == master_name;
         });
@@ -253,12 +509,516 @@ void ModEngine::initialize() {
         }
     }
 
+    // 4. Discover all mod definitions from the filesystem.
+    set_init_phase(InitPhase::MODS);
+    // Watch the disk from here on so later visits only rebuild what changed.
+    m_watcher.start(m_app_context.path_mod_archives, m_app_context.path_mod_data, m_app_context.path_openmw_cfg);
+
+    FsCounters before = fs_counters_snapshot();
+    // Before the scan, so copies of since-updated plugins never get listed.
+    drop_stale_cleaned_plugins();
+    discover_mod_definitions();
+    FsCounters used = fs_counters_snapshot() - before;
+    LOG_INFO("Mod discovery used ", used.opens, " opens, ", used.getdents, " getdents, ", used.stats, " stats.");
+
+    // Sync the UI state (checkboxes) with the final lists. Scripts launched
+    // from the main menu read the content list from here on, so its source
+    // mods are worked out aside and filled in by the main loop; the Mod
+    // Manager, which shows them, only opens after the next phase.
+    m_mod_manager.sync_ui_state_from_active_lists();
+    publish_snapshot();
+    auto sources = std::make_shared<std::unordered_map<StringId, StringId>>(collect_content_sources());
+    get_scheduler().then_on_main(nullptr, [this, sources]() { apply_content_sources(*sources); });
+    // The Mod Manager opens during the header phase, so take its list now.
+    std::vector<fs::path> header_paths = collect_plugin_header_paths();
+
+    // 5. Scan archives
+    set_init_phase(InitPhase::ARCHIVES);
+    rescan_archives();
+
+    // 6. Plugin headers, for everything that needs masters.
+    set_init_phase(InitPhase::PLUGIN_HEADERS);
+    index_plugin_headers(header_paths);
+
     m_is_initialized = true;
+    set_init_phase(InitPhase::READY);
     LOG_INFO("ModEngine: Initialization complete.");
 }
 
-void ModEngine::rescan_archives() {
-    m_archive_manager.scan_archives(m_app_context.path_mod_archives, m_app_context.path_mod_data);
+std::vector<fs::path> ModEngine::collect_plugin_header_paths() const {
+    std::set<std::string> seen;
+    std::vector<fs::path> plugins;
+    auto add_dir = [&](const fs::path& dir, StringId dir_id) {
+        for (StringId name : m_mod_manager.plugin_index.plugins_in(dir_id)) {
+            if (!is_tes3_plugin_name(interned(name))) continue;
+            fs::path plugin = dir / interned(name);
+            if (seen.insert(plugin.string()).second) plugins.push_back(plugin);
+        }
+    };
+    const ModStore& store = m_mod_manager.mod_store;
+    for (uint32_t o = 0; o < store.option_count(); ++o) add_dir(store.option_path(o), store.option_path_id(o));
+    for (const auto& path : m_mod_manager.active_data_paths) add_dir(path, intern(path.string()));
+    return plugins;
+}
+
+void ModEngine::index_plugin_headers(const std::vector<fs::path>& plugins, const CancelToken& cancel,
+                                     ProgressSink* progress) {
+    std::set<std::string> seen;
+    for (const auto& plugin : plugins) seen.insert(plugin.string());
+    auto start = std::chrono::steady_clock::now();
+    size_t read = m_plugin_headers.index(plugins, get_worker_pool(), cancel, progress);
+    cancel.throw_if_cancelled();
+    m_plugin_headers.retain_only(seen);
+    if (m_plugin_headers.is_dirty()) m_plugin_headers.save(m_app_context.path_config_dir / "openmw_esmm_headers.idx");
+    LOG_INFO("Plugin headers: ", plugins.size() - read, " cached, ", read, " read (",
+             std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count(),
+             " ms).");
+}
+
+size_t ModEngine::index_plugin_records(const std::vector<fs::path>& paths,
+                                       const std::unordered_map<StringId, fs::path>& load_paths,
+                                       const CancelToken& cancel, ProgressSink* progress) {
+    const fs::path cache_file = m_app_context.path_config_dir / "openmw_esmm_records.idx";
+    if (!m_record_cache_loaded) {
+        m_record_cache.load(cache_file);
+        m_record_cache_loaded = true;
+    }
+    size_t read = m_record_cache.index(paths, get_worker_pool(), cancel, progress);
+    cancel.throw_if_cancelled();
+    std::set<std::string> known;
+    for (const auto& pair : load_paths) known.insert(pair.second.string());
+    m_record_cache.retain_only(known);
+    if (m_record_cache.is_dirty()) m_record_cache.save(cache_file);
+    return read;
+}
+
+// Enabled TES3 plugins in load order, split into those with a load path and
+// those without.
+static void collect_enabled_plugins(const std::vector<ContentFile>& content_files,
+                                    const std::unordered_map<StringId, fs::path>& load_paths,
+                                    std::vector<StringId>& plugins, std::vector<fs::path>& paths,
+                                    std::vector<StringId>& missing) {
+    std::unordered_set<StringId> listed;
+    for (const auto& cf : content_files) {
+        if (!cf.enabled || !is_tes3_plugin_name(interned(cf.name)) || !listed.insert(cf.name).second) continue;
+        auto it = load_paths.find(cf.name);
+        if (it == load_paths.end()) {
+            missing.push_back(cf.name);
+            continue;
+        }
+        plugins.push_back(cf.name);
+        paths.push_back(it->second);
+    }
+}
+
+void ModEngine::check_conflicts(const PluginCheckInputs& inputs, const CancelToken& cancel, ProgressSink* progress) {
+    const std::unordered_map<StringId, fs::path>& load_paths = inputs.load_paths;
+    std::vector<StringId> plugins;
+    std::vector<fs::path> paths;
+    std::vector<StringId> unreadable;
+    collect_enabled_plugins(*inputs.snapshot->content_files, load_paths, plugins, paths, unreadable);
+    size_t read = index_plugin_records(paths, load_paths, cancel, progress);
+
+    std::vector<StringId> checked;
+    std::vector<std::shared_ptr<const PluginRecords>> records;
+    for (size_t i = 0; i < plugins.size(); ++i) {
+        std::shared_ptr<const PluginRecords> r = m_record_cache.lookup(paths[i]);
+        if (!r) {
+            unreadable.push_back(plugins[i]);
+            continue;
+        }
+        checked.push_back(plugins[i]);
+        records.push_back(std::move(r));
+    }
+
+    if (progress) progress->begin("Indexing records");
+    ConflictReport report = build_conflict_report(checked, records, get_worker_pool(), cancel);
+    report.unreadable = std::move(unreadable);
+    report.plugins_read = read;
+    LOG_INFO("Conflict check: ", report.records, " records in ", report.plugins.size(), " plugins (", read,
+             " read), ", report.conflicts.size(), " contested; indexed in ", report.build_ms, " ms.");
+
+    m_conflict_report = std::move(report);
+    m_conflict_report_lists = inputs.snapshot->generations.active_lists;
+    ++m_generations.conflicts;
+}
+
+static std::string lowercase(const std::string& s) {
+    std::string out(s);
+    std::transform(out.begin(), out.end(), out.begin(), ::tolower);
+    return out;
+}
+
+void ModEngine::check_dirty_plugins(const PluginCheckInputs& inputs, const CancelToken& cancel,
+                                    ProgressSink* progress) {
+    const std::unordered_map<StringId, fs::path>& load_paths = inputs.load_paths;
+    std::vector<StringId> plugins;
+    std::vector<fs::path> paths;
+    std::vector<StringId> unreadable;
+    collect_enabled_plugins(*inputs.snapshot->content_files, load_paths, plugins, paths, unreadable);
+
+    // Masters come from the headers and are matched by file name, in any
+    // case; they are read too, whether enabled or not.
+    std::unordered_map<std::string, fs::path> by_name;
+    for (const auto& pair : load_paths) by_name[lowercase(interned(pair.first))] = pair.second;
+    std::vector<std::vector<std::string>> masters(plugins.size());
+    std::vector<fs::path> to_read = paths;
+    std::set<fs::path> queued(paths.begin(), paths.end());
+    for (size_t i = 0; i < plugins.size(); ++i) {
+        PluginHeader header;
+        if (!m_plugin_headers.get(paths[i], header)) continue;
+        for (const auto& master : header.masters) {
+            masters[i].push_back(master.name);
+            auto it = by_name.find(lowercase(master.name));
+            if (it != by_name.end() && queued.insert(it->second).second) to_read.push_back(it->second);
+        }
+    }
+    if (m_plugin_headers.is_dirty()) m_plugin_headers.save(m_app_context.path_config_dir / "openmw_esmm_headers.idx");
+    size_t read = index_plugin_records(to_read, load_paths, cancel, progress);
+
+    std::unordered_map<std::string, std::shared_ptr<const PluginRecords>> available;
+    for (const auto& path : to_read) {
+        std::shared_ptr<const PluginRecords> r = m_record_cache.lookup(path);
+        if (r) available[lowercase(path.filename().string())] = std::move(r);
+    }
+    std::vector<DirtyCheckInput> checks;
+    for (size_t i = 0; i < plugins.size(); ++i) {
+        auto it = available.find(lowercase(paths[i].filename().string()));
+        if (it == available.end()) {
+            unreadable.push_back(plugins[i]);
+            continue;
+        }
+        DirtyCheckInput input;
+        input.plugin = plugins[i];
+        input.records = it->second;
+        input.masters = std::move(masters[i]);
+        checks.push_back(std::move(input));
+    }
+
+    if (progress) progress->begin("Comparing plugins with their masters");
+    DirtyReport report = m_dirty_checker.check(checks, available, get_worker_pool(), cancel);
+    report.unreadable = std::move(unreadable);
+    size_t dirty = 0;
+    for (const auto& plugin : report.plugins) {
+        if (plugin->is_dirty()) ++dirty;
+    }
+    LOG_INFO("Dirty edit check: ", dirty, " of ", report.plugins.size(), " plugins dirty (", read, " read, ",
+             report.reused, " unchanged) in ", report.check_ms, " ms.");
+
+    m_dirty_report = std::move(report);
+    m_dirty_report_lists = inputs.snapshot->generations.active_lists;
+    ++m_generations.dirty;
+}
+
+fs::path ModEngine::get_cleaned_plugins_dir() const {
+    return m_app_context.path_mod_data / "ESMM Cleaned Plugins";
+}
+
+void ModEngine::clean_dirty_plugins(const PluginCheckInputs& inputs, const std::vector<StringId>& plugins,
+                                    const CancelToken& cancel, ProgressSink* progress) {
+    // The base game's masters are left alone, ITMs or not.
+    const std::unordered_set<StringId> base_game = {intern("Morrowind.esm"), intern("Tribunal.esm"), intern("Bloodmoon.esm")};
+    const std::unordered_map<StringId, fs::path>& load_paths = inputs.load_paths;
+    std::unordered_map<StringId, std::shared_ptr<const PluginDirtyReport>> reports;
+    for (const auto& report : m_dirty_report.plugins) reports[report->plugin] = report;
+
+    std::vector<std::pair<fs::path, std::shared_ptr<const PluginDirtyReport>>> jobs;
+    uint64_t total = 0;
+    for (StringId name : plugins) {
+        auto report = reports.find(name);
+        auto path = load_paths.find(name);
+        if (base_game.count(name) || report == reports.end() || path == load_paths.end() ||
+            report->second->identical == 0) {
+            continue;
+        }
+        struct stat st;
+        if (stat_path(path->second, st)) total += static_cast<uint64_t>(st.st_size);
+        jobs.emplace_back(path->second, report->second);
+    }
+
+    const fs::path dir = get_cleaned_plugins_dir();
+    std::vector<CleanedCopy> manifest = load_cleaned_manifest(dir);
+    if (progress) progress->begin("Cleaning plugins", total);
+    size_t cleaned = 0;
+    for (const auto& job : jobs) {
+        CleanResult result;
+        const std::string name = job.first.filename().string();
+        if (clean_plugin(job.first, *job.second, dir / name, result, cancel, progress)) {
+            LOG_INFO("Cleaned ", name, ": ", result.removed, " records removed, ",
+                     result.bytes_in, " -> ", result.bytes_out, " bytes in ", result.clean_ms, " ms.");
+            ++cleaned;
+            // Re-cleaning a copy keeps the original it came from.
+            if (job.first.parent_path() != dir) {
+                manifest.erase(std::remove_if(manifest.begin(), manifest.end(),
+                                              [&](const CleanedCopy& copy) { return copy.name == name; }),
+                               manifest.end());
+                CleanedCopy copy;
+                copy.name = name;
+                copy.source = job.first;
+                copy.source_stamp = result.source_stamp;
+                manifest.push_back(std::move(copy));
+            }
+        } else if (!cancel.is_cancelled()) {
+            LOG_WARN("Could not clean ", job.first.string(), ": ", result.error);
+        }
+        if (cancel.is_cancelled()) break;
+    }
+
+    // Whatever was written is on disk either way.
+    if (cleaned) {
+        if (!save_cleaned_manifest(dir, manifest)) LOG_WARN("Could not write the cleaned plugin manifest in ", dir.string());
+        register_cleaned_plugins();
+    }
+    cancel.throw_if_cancelled();
+    // The lists just changed under this operation, which still owns them.
+    check_dirty_plugins(capture_plugin_check_inputs(), cancel, progress);
+}
+
+void ModEngine::restore_original_plugins(const CancelToken& cancel, ProgressSink* progress) {
+    const fs::path dir = get_cleaned_plugins_dir();
+    DirListing listing;
+    if (!read_directory(dir, listing)) return;
+    size_t removed = 0;
+    for (const auto& entry : listing.entries) {
+        if (entry.type == DirEntry::DIRECTORY || !is_tes3_plugin_name(entry.name)) continue;
+        boost::system::error_code ec;
+        if (fs::remove(dir / entry.name, ec)) ++removed;
+        else LOG_WARN("Could not remove ", (dir / entry.name).string(), ": ", ec.message());
+    }
+    save_cleaned_manifest(dir, {});
+    LOG_INFO("Restored ", removed, " original plugins.");
+    register_cleaned_plugins();
+    check_dirty_plugins(capture_plugin_check_inputs(), cancel, progress);
+}
+
+size_t ModEngine::drop_stale_cleaned_plugins() {
+    const fs::path dir = get_cleaned_plugins_dir();
+    std::vector<CleanedCopy> manifest = load_cleaned_manifest(dir);
+    size_t dropped = 0;
+    for (auto it = manifest.begin(); it != manifest.end();) {
+        if (it->source_unchanged()) {
+            ++it;
+            continue;
+        }
+        LOG_WARN("Original of cleaned plugin ", it->name, " changed (", it->source.string(), "); dropping the copy.");
+        boost::system::error_code ec;
+        fs::remove(dir / it->name, ec);
+        it = manifest.erase(it);
+        ++dropped;
+    }
+    if (dropped) save_cleaned_manifest(dir, manifest);
+    return dropped;
+}
+
+void ModEngine::register_cleaned_plugins() {
+    const fs::path dir = get_cleaned_plugins_dir();
+    refresh_mod_data({dir});
+    // Enabling appends its data path, so the copies override the originals.
+    uint32_t mod = m_mod_manager.mod_store.find_mod(dir);
+    if (mod != ModStore::NONE && !m_mod_manager.mod_store.mod_enabled(mod)) {
+        m_mod_manager.apply_mod_toggle(mod, true);
+    }
+    touch_active_lists();
+}
+
+void ModEngine::rescan_archives(const CancelToken& cancel, ProgressSink* progress) {
+    m_archive_manager.scan_archives(m_app_context.path_mod_archives, m_app_context.path_mod_data, cancel, progress);
+    ++m_generations.archives;
+}
+
+void ModEngine::refresh_mod_data(const std::vector<fs::path>& target_paths) {
+    std::set<fs::path> roots(target_paths.begin(), target_paths.end());
+    // An updated or removed mod may have been the original of a cleaned copy.
+    if (!roots.count(get_cleaned_plugins_dir()) && drop_stale_cleaned_plugins()) {
+        roots.insert(get_cleaned_plugins_dir());
+    }
+    for (const auto& root : roots) StatCache::instance().invalidate(root);
+    refresh_mods(roots);
+    for (const auto& root : roots) m_archive_manager.refresh_status(root);
+    ++m_generations.archives;
+}
+
+ModScanLimits ModEngine::get_scan_limits() const {
+    ModScanLimits limits;
+    if (m_app_context.scan_max_depth > 0) limits.max_depth = m_app_context.scan_max_depth;
+    if (m_app_context.scan_max_entries > 0) limits.max_entries = static_cast<uint64_t>(m_app_context.scan_max_entries);
+    return limits;
+}
+
+void ModEngine::log_scan_stats() const {
+    std::vector<const ModScanStats*> scanned;
+    for (const auto& st : m_scan_stats) {
+        if (st.cached) continue;
+        scanned.push_back(&st);
+        if (st.truncated) {
+            LOG_WARN("Scan of ", st.root.string(), " hit its budget after ", st.entries_read,
+                     " entries; some optional folders may be missing (see --scan-max-depth/--scan-max-entries).");
+        }
+        if (st.cycles) LOG_WARN("Skipped ", st.cycles, " looping directories in ", st.root.string());
+        LOG_DEBUG("Scanned ", st.root.string(), ": ", st.dirs_read, " dirs, ", st.entries_read, " entries, ",
+                  st.stats, " stats, ", st.wall_ms, " ms");
+    }
+    if (scanned.empty()) return;
+
+    std::sort(scanned.begin(), scanned.end(),
+              [](const ModScanStats* a, const ModScanStats* b) { return a->wall_ms > b->wall_ms; });
+    for (size_t i = 0; i < scanned.size() && i < 5; ++i) {
+        LOG_INFO("Slowest mod scan #", i + 1, ": ", scanned[i]->root.filename().string(), " (",
+                 scanned[i]->wall_ms, " ms, ", scanned[i]->entries_read, " entries)");
+    }
+}
+
+const VfsIndex& ModEngine::get_vfs_index() {
+    m_vfs_index.sync(*get_snapshot()->data_paths, &get_worker_pool());
+    return m_vfs_index;
+}
+
+void ModEngine::update_mod_watches() {
+    if (!m_watcher.is_active()) return;
+    std::set<fs::path> roots;
+    const ModStore& store = m_mod_manager.mod_store;
+    for (uint32_t m = 0; m < store.mod_count(); ++m) {
+        fs::path root = store.mod_root(m);
+        std::vector<fs::path> dirs = m_scan_index.dependent_dirs(root);
+        if (dirs.empty()) continue; // not an indexed mod (e.g. the base game)
+        roots.insert(root);
+        m_watcher.set_mod_dirs(root, dirs);
+    }
+    m_watcher.retain_mods(roots);
+}
+
+void ModEngine::refresh_mods(const std::set<fs::path>& mod_roots) {
+    // Edit a nested copy and swap it back in; refreshes are rare and small
+    // next to the reads the flat store serves.
+    std::vector<ModDefinition> mods = m_mod_manager.mod_store.to_definitions();
+    for (const auto& root : mod_roots) {
+        auto it = std::find_if(mods.begin(), mods.end(), [&](const ModDefinition& m) { return m.root_path == root; });
+
+        // Whatever this mod provided to the VFS may have changed.
+        if (it != mods.end()) {
+            for (const auto& group : it->option_groups) for (const auto& option : group.options) {
+                m_vfs_index.mark_dirty(option.path);
+            }
+        }
+
+        DirStamp stamp;
+        if (!read_dir_stamp(root, stamp)) {
+            if (it != mods.end()) {
+                LOG_INFO("Mod removed: ", root.string());
+                mods.erase(it);
+            }
+            m_scan_index.erase(root);
+            m_watcher.remove_mod(root);
+            m_scan_stats.erase(std::remove_if(m_scan_stats.begin(), m_scan_stats.end(),
+                                              [&](const ModScanStats& st) { return st.root == root; }),
+                               m_scan_stats.end());
+            continue;
+        }
+
+        // Only folders directly inside mod_data become mods on their own;
+        // anything else must already be known from the config's data paths.
+        if (it == mods.end()) {
+            fs::path relative = root.lexically_relative(m_app_context.path_mod_data);
+            bool top_level = !relative.empty() && std::distance(relative.begin(), relative.end()) == 1 &&
+                             relative.string() != "." && relative.string() != "..";
+            if (!top_level) continue;
+            LOG_INFO("Mod added: ", root.string());
+        }
+
+        ModDefinition mod;
+        ModScanStats scan_stats;
+        scan_stats.root = root;
+        scan_stats.cached = m_scan_index.lookup(root, mod);
+        if (!scan_stats.cached) {
+            std::vector<ListedDir> listed_dirs;
+            const ModScanLimits limits = get_scan_limits();
+            mod = parse_mod_directory(root, &listed_dirs, nullptr, &limits, &scan_stats);
+            if (!scan_stats.truncated) m_scan_index.store(root, mod, listed_dirs);
+        }
+        auto it_stats = std::find_if(m_scan_stats.begin(), m_scan_stats.end(),
+                                     [&](const ModScanStats& st) { return st.root == root; });
+        if (it_stats != m_scan_stats.end()) *it_stats = scan_stats;
+        else m_scan_stats.push_back(scan_stats);
+        for (const auto& group : mod.option_groups) for (const auto& option : group.options) {
+            m_vfs_index.mark_dirty(option.path);
+        }
+        if (it != mods.end()) *it = std::move(mod);
+        else mods.push_back(std::move(mod));
+
+        if (m_watcher.is_active()) m_watcher.set_mod_dirs(root, m_scan_index.dependent_dirs(root));
+    }
+    sort_mod_definitions(mods);
+    m_mod_manager.set_mods(mods);
+    for (const auto& root : mod_roots) {
+        uint32_t m = m_mod_manager.mod_store.find_mod(root);
+        if (m != ModStore::NONE) m_mod_manager.sync_ui_state_for(m);
+    }
+    ++m_generations.mods;
+    publish_snapshot();
+
+    if (m_scan_index.is_dirty()) {
+        m_scan_index.save(m_app_context.path_config_dir / "openmw_esmm_scan.idx");
+    }
+}
+
+void ModEngine::reload_configuration(const CancelToken& cancel, ProgressSink* progress) {
+    LOG_INFO("openmw.cfg changed on disk, reloading data and content lists.");
+    m_config_manager.load(m_app_context.path_openmw_cfg);
+    ++m_generations.config;
+    load_active_lists_from_config();
+    // A cancelled discovery keeps the previous mods; sync the new lists to those.
+    bool cancelled = false;
+    try {
+        discover_mod_definitions(cancel, progress);
+    } catch (const OperationCancelled&) {
+        cancelled = true;
+    }
+    update_content_sources();
+    m_mod_manager.sync_ui_state_from_active_lists();
+    publish_snapshot();
+    if (cancelled) throw OperationCancelled();
+}
+
+FsChangeResult ModEngine::process_fs_changes() {
+    if (!m_watcher.is_active()) return FsChangeResult::NONE;
+    FsChangeSet changes = m_watcher.poll();
+    if (changes.empty()) return FsChangeResult::NONE;
+
+    // Whatever changed on disk, cached stat results for it are stale.
+    StatCache& stat_cache = StatCache::instance();
+    if (changes.overflowed) {
+        stat_cache.invalidate_all();
+        LOG_WARN("Filesystem watcher overflowed; a full rescan is needed.");
+        return FsChangeResult::OVERFLOWED;
+    }
+
+    for (const auto& root : changes.mod_roots) stat_cache.invalidate(root);
+    for (const auto& archive_path : changes.archives) stat_cache.invalidate(archive_path);
+    if (changes.config_changed) stat_cache.invalidate(m_app_context.path_openmw_cfg);
+
+    bool external_cfg_edit = false;
+    if (changes.config_changed) {
+        FileStamp stamp;
+        external_cfg_edit = !read_file_stamp(m_app_context.path_openmw_cfg, stamp) || stamp != m_saved_cfg_stamp;
+    }
+
+    if (!changes.mod_roots.empty()) {
+        if (drop_stale_cleaned_plugins()) changes.mod_roots.insert(get_cleaned_plugins_dir());
+        refresh_mods(changes.mod_roots);
+    }
+
+    for (const auto& archive_path : changes.archives) {
+        m_archive_manager.update_archive(archive_path, m_app_context.path_mod_data);
+    }
+    // Extraction and deletion change the marker file an archive's status is read from.
+    for (const auto& root : changes.mod_roots) {
+        m_archive_manager.refresh_status(root);
+    }
+    if (!changes.archives.empty() || !changes.mod_roots.empty()) ++m_generations.archives;
+
+    LOG_DEBUG("Applied filesystem changes: ", changes.archives.size(), " archives, ",
+              changes.mod_roots.size(), " mods", external_cfg_edit ? ", config" : "");
+    return external_cfg_edit ? FsChangeResult::CONFIG_CHANGED : FsChangeResult::APPLIED;
 }
 
 
@@ -298,8 +1058,8 @@ bool ModEngine::write_temporary_cfg(const fs::path& temp_cfg_path) {
         } else if (trimmed_line.rfind("content=", 0) == 0 || trimmed_line.rfind("#content=", 0) == 0) {
             if (!content_written) {
                 for (const auto& cf : m_mod_manager.active_content_files) {
-                    if (cf.enabled) temp_file << "content=\"" << cf.name << "\"\n";
-                    else temp_file << "#content=\"" << cf.name << "\"\n";
+                    if (cf.enabled) temp_file << "content=\"" << interned(cf.name) << "\"\n";
+                    else temp_file << "#content=\"" << interned(cf.name) << "\"\n";
                 }
                 content_written = true;
             }
@@ -310,29 +1070,33 @@ bool ModEngine::write_temporary_cfg(const fs::path& temp_cfg_path) {
     return true;
 }
 
-void ModEngine::delete_mod_data(const std::vector<fs::path>& paths_to_delete) {
+void ModEngine::delete_mod_data(const std::vector<fs::path>& paths_to_delete, const CancelToken& cancel,
+                                ProgressSink* progress) {
     // 1. Identify which mods are being deleted by their root path.
-    std::set<std::string> deleted_mod_names;
-    for (const auto& mod : m_mod_manager.mod_definitions) {
-        for (const auto& path_to_del : paths_to_delete) {
-            if (mod.root_path == path_to_del) {
-                deleted_mod_names.insert(mod.name);
-                break;
+    std::unordered_set<StringId> deleted_mod_names;
+    PathTrie<char> deleted_roots;
+    const ModStore& store = m_mod_manager.mod_store;
+    PluginIndex& plugin_index = m_mod_manager.plugin_index;
+    for (const auto& path_to_del : paths_to_delete) {
+        deleted_roots.insert(path_to_del, 1);
+        for (uint32_t mod : m_mod_manager.mods_under(path_to_del)) {
+            deleted_mod_names.insert(store.mod_name_id(mod));
+            for (uint32_t o = store.mod_options_begin(mod); o < store.mod_options_end(mod); ++o) {
+                plugin_index.remove_path(store.option_path_id(o));
             }
         }
     }
 
-    // 2. Remove associated data paths.
+    ++m_generations.active_lists;
+    m_mod_manager.invalidate_active_lists();
+
+    // 2. Remove associated data paths (anything inside a deleted root).
     auto& data_paths = m_mod_manager.active_data_paths;
     data_paths.erase(std::remove_if(data_paths.begin(), data_paths.end(),
         [&](const fs::path& p) {
-            for (const auto& del_path : paths_to_delete) {
-                // Check if p is inside del_path
-                if (p.string().find(del_path.string()) == 0) {
-                    return true;
-                }
-            }
-            return false;
+            if (deleted_roots.find_owner(p) == nullptr) return false;
+            plugin_index.remove_path(intern(p.string()));
+            return true;
         }), data_paths.end());
 
     // 3. Remove associated content files using the source_mod name.
@@ -343,12 +1107,17 @@ void ModEngine::delete_mod_data(const std::vector<fs::path>& paths_to_delete) {
         }), content_files.end());
 
     // 4. Finally, delete the actual files from the disk.
+    if (progress) progress->begin("Deleting mod data");
     for (const auto& path : paths_to_delete) {
+        if (cancel.is_cancelled()) break;
         if (fs::exists(path)) {
             LOG_INFO("Deleting mod data at: ", path.string());
-            fs::remove_all(path);
+            if (!remove_tree(path, cancel, progress)) LOG_WARN("Deletion of ", path.string(), " was cancelled part-way.");
+            StatCache::instance().invalidate(path);
         }
     }
+    publish_snapshot();
+    cancel.throw_if_cancelled();
 }
 
 
@@ -362,6 +1131,10 @@ void ModEngine::save_configuration() {
     data_to_save.data_paths = m_mod_manager.active_data_paths;
     data_to_save.content_files = m_mod_manager.active_content_files;
     m_config_manager.save(m_app_context.path_openmw_cfg, data_to_save);
+    // Remember what we wrote so the watcher doesn't treat it as an external edit.
+    read_file_stamp(m_app_context.path_openmw_cfg, m_saved_cfg_stamp);
+    ++m_generations.config;
+    m_saved_active_lists = m_generations.active_lists;
 }
 
 
@@ -375,6 +1148,20 @@ void ModEngine::run_active_sorter(ScriptRegistration type) {
         return;
     }
 
+    if (type == ScriptRegistration::SORT_CONTENT && m_script_manager.is_native_content_sorter_active()) {
+        // It reads the plugin index and headers that initialization is still building.
+        if (!init_phase_done(InitPhase::PLUGIN_HEADERS)) {
+            m_state_machine->push_scene(std::make_unique<AlertScene>(
+                *m_state_machine,
+                "Not Ready",
+                "Plugin headers are still being read. Try sorting again in a moment."
+            ));
+            return;
+        }
+        run_native_content_sorter();
+        return;
+    }
+
     fs::path sorter_path = (type == ScriptRegistration::SORT_DATA)
         ? m_script_manager.get_active_data_sorter_path()
         : m_script_manager.get_active_content_sorter_path();
@@ -405,39 +1192,42 @@ void ModEngine::run_active_sorter(ScriptRegistration type) {
             LOG_INFO("--- Data Load Order BEFORE Applying ---");
             for(const auto& p : m_mod_manager.active_data_paths) LOG_INFO(p.string());
 
-            std::map<fs::path, fs::path> abs_to_original_path_map;
+            std::unordered_map<StringId, fs::path> abs_to_original_path_map;
             fs::path original_cfg_dir = m_app_context.path_openmw_cfg.parent_path();
             for (const auto& original_path : m_mod_manager.active_data_paths) {
-                abs_to_original_path_map[fs::absolute(original_path, original_cfg_dir)] = original_path;
+                abs_to_original_path_map[intern(fs::absolute(original_path, original_cfg_dir).string())] = original_path;
             }
 
             std::vector<fs::path> new_sorted_data_paths;
             for (const auto& new_abs_path : new_config_data.data_paths) {
-                if (abs_to_original_path_map.count(new_abs_path)) {
-                    new_sorted_data_paths.push_back(abs_to_original_path_map[new_abs_path]);
+                auto it = abs_to_original_path_map.find(intern(new_abs_path.string()));
+                if (it != abs_to_original_path_map.end()) {
+                    new_sorted_data_paths.push_back(it->second);
                 } else {
                     new_sorted_data_paths.push_back(new_abs_path);
                 }
             }
             m_mod_manager.active_data_paths = new_sorted_data_paths;
-            
-            std::map<std::string, ContentFile> old_cf_map;
-            for(const auto& cf : m_mod_manager.active_content_files) old_cf_map[cf.name] = cf;
+            m_mod_manager.plugin_index.set_active_paths(new_sorted_data_paths);
 
             std::vector<ContentFile> final_content_files;
             for(const auto& new_cf : new_config_data.content_files) {
+                StringId source = m_mod_manager.plugin_index.source_mod(new_cf.name);
                 final_content_files.push_back(ContentFile{
                     new_cf.name, 
                     new_cf.enabled, 
-                    old_cf_map.count(new_cf.name) ? old_cf_map[new_cf.name].source_mod : "Unknown"
+                    source != StringPool::EMPTY ? source : new_cf.source_mod
                 });
             }
             m_mod_manager.active_content_files = final_content_files;
+            m_mod_manager.invalidate_active_lists();
 
             LOG_INFO("--- Data Load Order AFTER applying ---");
             for(const auto& p : m_mod_manager.active_data_paths) LOG_INFO(p.string());
 
             m_mod_manager.sync_ui_state_from_active_lists();
+            ++m_generations.active_lists;
+            publish_snapshot();
         }
     } else {
         LOG_ERROR("Sorter script failed with code ", result.return_code, ". No changes applied.");
@@ -449,6 +1239,79 @@ void ModEngine::run_active_sorter(ScriptRegistration type) {
     }
 }
 
+std::unordered_map<StringId, fs::path> ModEngine::get_plugin_load_paths() const {
+    std::unordered_map<StringId, fs::path> paths;
+    for (const auto& dir : m_mod_manager.active_data_paths) {
+        for (StringId name : m_mod_manager.plugin_index.plugins_in(intern(dir.string()))) {
+            paths[name] = dir / interned(name);
+        }
+    }
+    return paths;
+}
+
+PluginCheckInputs ModEngine::capture_plugin_check_inputs() const {
+    PluginCheckInputs inputs;
+    inputs.snapshot = get_snapshot();
+    inputs.load_paths = get_plugin_load_paths();
+    return inputs;
+}
+
+void ModEngine::run_native_content_sorter() {
+    auto start = std::chrono::steady_clock::now();
+    auto& content_files = m_mod_manager.active_content_files;
+    std::unordered_map<StringId, fs::path> load_paths = get_plugin_load_paths();
+
+    std::vector<StringId> plugins;
+    std::vector<std::vector<StringId>> masters(content_files.size());
+    for (size_t i = 0; i < content_files.size(); ++i) {
+        plugins.push_back(content_files[i].name);
+        auto it = load_paths.find(content_files[i].name);
+        PluginHeader header;
+        if (it == load_paths.end() || !m_plugin_headers.get(it->second, header)) continue;
+        for (const auto& master : header.masters) masters[i].push_back(intern(master.name));
+    }
+
+    ContentSortReport report;
+    std::vector<uint32_t> order = sort_by_masters(plugins, masters, &report);
+    std::vector<ContentFile> sorted;
+    sorted.reserve(order.size());
+    for (uint32_t i : order) sorted.push_back(content_files[i]);
+    if (m_plugin_headers.is_dirty()) m_plugin_headers.save(m_app_context.path_config_dir / "openmw_esmm_headers.idx");
+
+    LOG_INFO("Native content sort: ", report.moved, " of ", plugins.size(), " plugins moved in ",
+             std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count(),
+             " us.");
+
+    // Only problems with enabled plugins are worth interrupting the user for.
+    std::unordered_set<StringId> enabled;
+    for (const auto& cf : content_files) {
+        if (cf.enabled) enabled.insert(cf.name);
+    }
+    std::string problems;
+    for (const auto& missing : report.missing_masters) {
+        LOG_WARN(interned(missing.first), " needs master ", interned(missing.second), ", which is not in the content list.");
+        if (enabled.count(missing.first)) {
+            problems += std::string(interned(missing.first)) + " needs " + interned(missing.second) + "\n";
+        }
+    }
+    if (!report.cycle.empty()) {
+        std::string names;
+        for (StringId name : report.cycle) names += std::string(names.empty() ? "" : ", ") + interned(name);
+        LOG_WARN("Plugins with circular masters were left at the end: ", names);
+        problems += "Circular masters: " + names + "\n";
+    }
+
+    if (report.moved > 0) {
+        content_files = std::move(sorted);
+        m_mod_manager.invalidate_active_lists();
+        m_mod_manager.sync_ui_state_from_active_lists();
+        ++m_generations.active_lists;
+        publish_snapshot();
+    }
+    if (!problems.empty()) {
+        m_state_machine->push_scene(std::make_unique<AlertScene>(*m_state_machine, "Load Order Problems", problems));
+    }
+}
 
 void ModEngine::run_active_verifier() {
     fs::path verifier_path = m_script_manager.get_active_content_verifier_path();
@@ -483,13 +1346,20 @@ bool ModEngine::has_active_verifier() const {
 }
 
 void ModEngine::add_running_script(ScriptRunner* runner) {
+    std::lock_guard<std::mutex> lock(m_running_scripts_mutex);
     m_running_scripts.insert(runner);
+    // A script task still queued at shutdown may only start now.
+    if (m_shutting_down) runner->kill_process();
 }
 
 void ModEngine::remove_running_script(ScriptRunner* runner) {
+    std::lock_guard<std::mutex> lock(m_running_scripts_mutex);
     m_running_scripts.erase(runner);
 }
 
-const std::set<ScriptRunner*>& ModEngine::get_running_scripts() const {
-    return m_running_scripts;
+void ModEngine::kill_running_scripts() {
+    // Runners stay alive while registered: they unregister before their task returns.
+    std::lock_guard<std::mutex> lock(m_running_scripts_mutex);
+    m_shutting_down = true;
+    for (ScriptRunner* runner : m_running_scripts) runner->kill_process();
 }
@@ -3,28 +3,124 @@
 #include "../mod/ArchiveManager.h"
 #include "../mod/ConfigManager.h"
 #include "../mod/ScriptManager.h"
+#include "../mod/ScanIndex.h"
+#include "../mod/PluginHeaderCache.h"
+#include "../mod/RecordCache.h"
+#include "../mod/ConflictIndex.h"
+#include "../mod/DirtyCheck.h"
+#include "../mod/VfsIndex.h"
+#include "FileWatcher.h"
 #include "../AppContext.h"
+#include "../utils/Progress.h"
+#include "../utils/TaskScheduler.h"
+#include "../utils/WorkerPool.h"
 #include <vector>
 #include <string>
 #include <set>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <unordered_map>
 
 // Forward declare this to avoid a circular reference.
 class ScriptRunner;
 class StateMachine;
 
 // Forward declarations
-ModDefinition parse_mod_directory(const fs::path& mod_root_path);
 bool is_plugin_file(const fs::path& path);
 
+// Startup phases, in the order initialize() runs them.
+enum class InitPhase { SCRIPTS, CONFIG, CONTENT_LISTS, MODS, ARCHIVES, PLUGIN_HEADERS, READY };
+const char* init_phase_name(InitPhase phase);
+
+// What ModEngine::process_fs_changes() did.
+enum class FsChangeResult {
+    NONE,       // nothing pending
+    APPLIED,    // the affected archives, mods or lists were rebuilt
+    OVERFLOWED, // events were lost; the caller must start a full rescan
+    CONFIG_CHANGED, // as APPLIED, but openmw.cfg was edited elsewhere; the
+                    // caller decides when to run reload_configuration()
+};
+
+// Monotonic change counters, one per subsystem. Scenes remember the values
+// they last built derived state from and rebuild only when one advances.
+struct EngineGenerations {
+    uint64_t archives = 0;      // ArchiveManager::archives
+    uint64_t mods = 0;          // ModManager::mod_store
+    uint64_t active_lists = 0;  // active data paths and content files
+    uint64_t config = 0;        // openmw.cfg as loaded or last saved
+    uint64_t conflicts = 0;     // ModEngine::get_conflict_report()
+    uint64_t dirty = 0;         // ModEngine::get_dirty_report()
+};
+
+// Immutable copy of the mods and active lists, published by the thread that
+// owns ModManager whenever they change. Readers on any thread hold on to a
+// snapshot for as long as they need it; the writer never mutates one, it
+// builds and publishes the next. Parts that did not change are shared with
+// the previous snapshot, so publishing after a toggle or reorder copies at
+// most the lists that moved, never the ModStore.
+struct EngineSnapshot {
+    EngineGenerations generations;
+    // Replaced only when generations.mods moves. Its enabled flags are only
+    // as fresh as that; the active lists below are what counts.
+    std::shared_ptr<const ModStore> mods = std::make_shared<const ModStore>();
+    std::shared_ptr<const std::vector<fs::path>> data_paths = std::make_shared<const std::vector<fs::path>>();
+    std::shared_ptr<const std::vector<ContentFile>> content_files = std::make_shared<const std::vector<ContentFile>>();
+};
+
+// What a background plugin check reads, captured on the main thread when
+// its operation starts, so the worker never touches the live ModManager.
+struct PluginCheckInputs {
+    std::shared_ptr<const EngineSnapshot> snapshot;
+    std::unordered_map<StringId, fs::path> load_paths; // see ModEngine::get_plugin_load_paths()
+};
+
 class ModEngine {
 public:
     // Constructor now requires the AppContext
     ModEngine(AppContext& ctx);
+    ~ModEngine();
     
     // Initialize no longer needs the context passed in
     void initialize();
-    void rescan_archives();
-    void rescan_mods();
+
+    // Runs initialize() as a scheduler task. Anything touching state a
+    // phase builds must wait until init_phase_done() says it has finished.
+    void start_initialization();
+    void wait_for_initialization();
+    InitPhase init_phase() const { return m_init_phase.load(); }
+    bool init_phase_done(InitPhase phase) const { return m_init_phase.load() > phase; }
+    // Empty unless initialization threw.
+    std::string get_init_error() const;
+    // Both throw OperationCancelled, keeping the previous lists, if cancelled.
+    void rescan_archives(const CancelToken& cancel = CancelToken(), ProgressSink* progress = nullptr);
+    void rescan_mods(const CancelToken& cancel = CancelToken(), ProgressSink* progress = nullptr);
+
+    // Re-reads just the given mod_data folders (after an extract or delete)
+    // and the install status of the archives that target them.
+    void refresh_mod_data(const std::vector<fs::path>& target_paths);
+
+    const EngineGenerations& get_generations() const { return m_generations; }
+    // For callers that edit the active lists directly (the UI).
+    void touch_active_lists();
+
+    // Latest published snapshot (never null). Lock-free; safe from any thread.
+    std::shared_ptr<const EngineSnapshot> get_snapshot() const { return std::atomic_load(&m_snapshot); }
+
+    // Applies pending inotify events, rebuilding only the affected archives
+    // and mods. A full rescan or config reload is too long for the caller's
+    // frame, so on overflow or an external openmw.cfg edit it only says so.
+    FsChangeResult process_fs_changes();
+    // Re-reads openmw.cfg, replacing the in-memory lists, and rescans mods.
+    // Throws OperationCancelled; the new lists are kept either way.
+    void reload_configuration(const CancelToken& cancel = CancelToken(), ProgressSink* progress = nullptr);
+    // True if the active lists changed since they were last loaded or saved.
+    bool has_unsaved_list_changes() const { return m_generations.active_lists != m_saved_active_lists; }
+    // False if inotify is unavailable; callers must then rescan themselves.
+    bool has_fs_watcher() const { return m_watcher.is_active(); }
 
     void run_active_sorter(ScriptRegistration type);
     void run_active_verifier();
@@ -35,7 +131,22 @@ public:
     void save_configuration();
     bool write_temporary_cfg(const fs::path& temp_cfg_path);
 
-    void delete_mod_data(const std::vector<fs::path>& paths_to_delete);
+    // Cancelling stops between files: the lists are already updated, and
+    // whatever was not yet removed stays on disk. Throws OperationCancelled.
+    void delete_mod_data(const std::vector<fs::path>& paths_to_delete, const CancelToken& cancel = CancelToken(),
+                         ProgressSink* progress = nullptr);
+
+    // --- Long operations ---
+    // Runs `op` (a rescan, a deletion, ...) as a scheduler task, one at a
+    // time. While is_busy(), the UI must leave engine state alone and only
+    // show get_operation_progress() and offer cancel_operation(). Main thread only.
+    typedef std::function<void(const CancelToken&, ProgressSink&)> Operation;
+    bool start_operation(const std::string& label, Operation op);
+    bool is_busy() const { return m_operation_task != nullptr; }
+    const std::string& get_operation_label() const { return m_operation_label; }
+    ProgressSink::Snapshot get_operation_progress() const { return m_operation_progress.snapshot(); }
+    void cancel_operation() { m_operation_cancel.cancel(); }
+    bool is_operation_cancelled() const { return m_operation_cancel.is_cancelled(); }
 
     const ModManager& get_mod_manager() const { return m_mod_manager; }
     const ArchiveManager& get_archive_manager() const { return m_archive_manager; }
@@ -48,12 +159,102 @@ public:
     StateMachine& get_state_machine();
     void set_state_machine(StateMachine& machine);
 
+    // Engine-wide task scheduler for all background work (sized by --scan-workers).
+    TaskScheduler& get_scheduler();
+    // Bulk-priority fan-out on the scheduler, used for parallel filesystem scans.
+    WorkerPool& get_worker_pool();
+
+    // VFS model of the current active data paths, brought up to date on
+    // access. The first sync walks every data path: call it from an operation.
+    const VfsIndex& get_vfs_index();
+    const VfsMetrics& get_vfs_index_metrics() const { return m_vfs_index.metrics(); }
+
+    // TES3 headers (masters, record counts, ...) of every known plugin.
+    // Thread-safe; get() re-reads a header whose file changed since.
+    PluginHeaderCache& get_plugin_headers() { return m_plugin_headers; }
+    // Where each available plugin loads from: the file in the last active
+    // data path that provides it (later data paths override earlier ones).
+    std::unordered_map<StringId, fs::path> get_plugin_load_paths() const;
+    // The current snapshot plus plugin load paths. Reads the live plugin
+    // index, so call it where the ModManager may be read: the main thread.
+    PluginCheckInputs capture_plugin_check_inputs() const;
+
+    // Record-level conflicts between the enabled plugins, in load order.
+    // Only plugins that changed on disk since the last check are read; the
+    // rest come from the persistent record cache. Throws OperationCancelled.
+    void check_conflicts(const PluginCheckInputs& inputs, const CancelToken& cancel = CancelToken(),
+                         ProgressSink* progress = nullptr);
+    const ConflictReport& get_conflict_report() const { return m_conflict_report; }
+    // The active_lists generation the report was built from.
+    uint64_t get_conflict_report_lists() const { return m_conflict_report_lists; }
+
+    // Dirty edits in every enabled plugin: records identical to their master's
+    // version, and deleted master records and references. Plugins whose
+    // records and masters are unchanged keep their previous result. Throws
+    // OperationCancelled.
+    void check_dirty_plugins(const PluginCheckInputs& inputs, const CancelToken& cancel = CancelToken(),
+                             ProgressSink* progress = nullptr);
+    const DirtyReport& get_dirty_report() const { return m_dirty_report; }
+    uint64_t get_dirty_report_lists() const { return m_dirty_report_lists; }
+
+    // Writes a copy of each of `plugins` without its identical-to-master
+    // records (as found by the last dirty check) into the cleaned-plugins
+    // mod in mod_data, which is then enabled so the copies load instead of
+    // the untouched originals. Re-runs the dirty check. Registering the copies
+    // edits the live lists, so this relies on running as the one operation.
+    // Throws OperationCancelled.
+    void clean_dirty_plugins(const PluginCheckInputs& inputs, const std::vector<StringId>& plugins,
+                             const CancelToken& cancel = CancelToken(), ProgressSink* progress = nullptr);
+    // Deletes every cleaned copy, so the originals load again.
+    void restore_original_plugins(const CancelToken& cancel = CancelToken(), ProgressSink* progress = nullptr);
+    // Deletes every cleaned copy whose original changed or vanished since it
+    // was cleaned, so an updated mod is never shadowed by a stale copy.
+    // Returns how many; the caller refreshes the cleaned-plugins mod.
+    size_t drop_stale_cleaned_plugins();
+    fs::path get_cleaned_plugins_dir() const;
+
+    // Cost of scanning each mod in the last discovery (or its latest refresh).
+    const std::vector<ModScanStats>& get_scan_stats() const { return m_scan_stats; }
+
+    // Called by runners from their scheduler task, around the child's lifetime.
     void add_running_script(ScriptRunner* runner);
     void remove_running_script(ScriptRunner* runner);
-    const std::set<ScriptRunner*>& get_running_scripts() const;
+    // Kills the process group of every running script. Their tasks block on
+    // the child's output, so this must happen before the scheduler joins.
+    void kill_running_scripts();
 
 private:
-    void discover_mod_definitions();
+    void discover_mod_definitions(const CancelToken& cancel = CancelToken(), ProgressSink* progress = nullptr);
+    void load_active_lists_from_config();
+    // The mod providing each active content file, per the plugin index.
+    std::unordered_map<StringId, StringId> collect_content_sources() const;
+    void apply_content_sources(const std::unordered_map<StringId, StringId>& sources);
+    void update_content_sources() { apply_content_sources(collect_content_sources()); }
+    void refresh_mods(const std::set<fs::path>& mod_roots);
+    void update_mod_watches();
+    void set_init_phase(InitPhase phase);
+    ModScanLimits get_scan_limits() const;
+    void log_scan_stats() const;
+    // Built-in SORT_CONTENT: stable topological sort by plugin masters.
+    void run_native_content_sorter();
+    // Every plugin in a mod option or active data path. Reads the ModManager,
+    // so it runs wherever that may be read; the result is a plain copy.
+    std::vector<fs::path> collect_plugin_header_paths() const;
+    // Reads the headers of those of `plugins` the cache doesn't already hold,
+    // drops the rest, and saves the cache. Touches only the header cache.
+    void index_plugin_headers(const std::vector<fs::path>& plugins, const CancelToken& cancel = CancelToken(),
+                              ProgressSink* progress = nullptr);
+    // Brings the record cache up to date for `paths` (loading it on first
+    // use), drops plugins no longer in `load_paths`, and saves it. Returns
+    // how many plugins had to be read.
+    size_t index_plugin_records(const std::vector<fs::path>& paths,
+                                const std::unordered_map<StringId, fs::path>& load_paths,
+                                const CancelToken& cancel, ProgressSink* progress);
+    // Picks up the cleaned-plugins mod after its files changed, enabling it.
+    void register_cleaned_plugins();
+    // Copies the current mods and active lists into a new snapshot.
+    // Called by the owning thread after every change to either.
+    void publish_snapshot();
 
     StateMachine* m_state_machine = nullptr;
 
@@ -62,9 +263,42 @@ private:
     ArchiveManager m_archive_manager;
     ConfigManager m_config_manager;
     ScriptManager m_script_manager;
+    ScanIndex m_scan_index;
+    PluginHeaderCache m_plugin_headers;
+    RecordCache m_record_cache;
+    bool m_record_cache_loaded = false; // loaded on the first conflict check
+    ConflictReport m_conflict_report;
+    uint64_t m_conflict_report_lists = 0;
+    DirtyChecker m_dirty_checker;
+    DirtyReport m_dirty_report;
+    uint64_t m_dirty_report_lists = 0;
+    VfsIndex m_vfs_index;
+    std::vector<ModScanStats> m_scan_stats;
+    std::unique_ptr<WorkerPool> m_worker_pool;
+    std::once_flag m_scheduler_once;
+    FileWatcher m_watcher;
+    FileStamp m_saved_cfg_stamp; // openmw.cfg as we last wrote it
+    uint64_t m_saved_active_lists = 0; // m_generations.active_lists as of the last load or save
+    EngineGenerations m_generations;
+    std::shared_ptr<const EngineSnapshot> m_snapshot = std::make_shared<EngineSnapshot>();
 
     bool m_is_initialized = false;
+    TaskHandle m_init_task;
+    std::atomic<InitPhase> m_init_phase{InitPhase::SCRIPTS};
+    std::chrono::steady_clock::time_point m_phase_start;
+    mutable std::mutex m_init_error_mutex;
+    std::string m_init_error;
     std::vector<fs::path> m_mod_source_dirs;
 
+    std::mutex m_running_scripts_mutex;
     std::set<ScriptRunner*> m_running_scripts;
+    bool m_shutting_down = false; // scripts that start after this are killed at once
+
+    TaskHandle m_operation_task;
+    std::string m_operation_label;
+    CancelToken m_operation_cancel;
+    ProgressSink m_operation_progress;
+
+    // Declared last so it is destroyed first: queued tasks still see a whole engine.
+    std::unique_ptr<TaskScheduler> m_scheduler;
 };
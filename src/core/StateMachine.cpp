@@ -1,8 +1,15 @@
 #include "StateMachine.h"
+#include "../utils/DirListing.h"
+#include "../utils/Logger.h"
 
 StateMachine::StateMachine(AppContext& ctx) : m_context(ctx), m_engine(ctx) {
     m_engine.set_state_machine(*this);
-    m_engine.initialize();
+    m_engine.start_initialization();
+}
+
+StateMachine::~StateMachine() {
+    // The init task may still be pushing scenes; let it finish first.
+    m_engine.wait_for_initialization();
 }
 
 void StateMachine::handle_event(SDL_Event& e) {
@@ -10,42 +17,48 @@ void StateMachine::handle_event(SDL_Event& e) {
 }
 
 void StateMachine::update() {
+    // Main-loop continuations of finished background tasks go first, so a
+    // scene sees their results in this frame's update().
+    m_engine.get_scheduler().run_main_continuations();
     if (!m_states.empty()) m_states.back()->update();
     process_state_changes();
 }
 
 void StateMachine::render() {
-    if (!m_states.empty()) m_states.back()->render();
+    if (m_states.empty()) return;
+    // render() runs every frame; anything that touches the disk belongs in
+    // update() or behind StatCache. Flag frames that slipped through.
+    FsCounters before = fs_thread_counters_snapshot();
+    m_states.back()->render();
+    FsCounters used = fs_thread_counters_snapshot() - before;
+    uint64_t syscalls = used.opens + used.getdents + used.stats;
+    if (syscalls == 0) return;
+    if (m_render_syscall_frames == 0 || (m_render_syscall_frames & 1023) == 0) {
+        LOG_DEBUG("render() issued ", syscalls, " filesystem syscalls this frame (", used.opens, " opens, ",
+                  used.getdents, " getdents, ", used.stats, " stats); ", m_render_syscall_frames + 1, " such frames so far.");
+    }
+    ++m_render_syscall_frames;
+    m_render_syscalls += syscalls;
 }
 
 void StateMachine::push_scene(std::unique_ptr<Scene> scene) {
-    std::lock_guard<std::mutex> lock(m_pending_changes_mutex);
-    m_pending_changes.push_back({PendingChange::Push, std::move(scene)});
+    m_pending_changes.push({PendingChange::Push, std::move(scene)});
 }
 
 void StateMachine::pop_state() {
-    std::lock_guard<std::mutex> lock(m_pending_changes_mutex);
-    m_pending_changes.push_back({PendingChange::Pop, nullptr});
+    m_pending_changes.push({PendingChange::Pop, nullptr});
 }
 
 void StateMachine::change_scene(std::unique_ptr<Scene> scene) {
-    std::lock_guard<std::mutex> lock(m_pending_changes_mutex);
-    m_pending_changes.push_back({PendingChange::Change, std::move(scene)});
+    m_pending_changes.push({PendingChange::Change, std::move(scene)});
 }
 
 void StateMachine::process_state_changes() {
-    // To prevent deadlocks, we copy the pending changes inside a lock
-    // and then process them outside the lock.
-    std::vector<PendingChange> changes_to_process;
-    {
-        std::lock_guard<std::mutex> lock(m_pending_changes_mutex);
-        if (m_pending_changes.empty()) {
-            return;
-        }
-        changes_to_process.swap(m_pending_changes);
-    }
+    // Usually nothing is queued; that check is a single atomic load. Changes
+    // queued by a scene's on_enter() below wait for the next frame.
+    if (m_pending_changes.empty()) return;
 
-    for (auto& change : changes_to_process) {
+    m_pending_changes.drain([this](PendingChange&& change) {
         switch (change.action) {
             case PendingChange::Push:
                 if (change.scene) {
@@ -72,7 +85,7 @@ void StateMachine::process_state_changes() {
                 }
                 break;
         }
-    }
+    });
 
     if (m_states.empty()) m_context.running = false;
 }
@@ -1,15 +1,15 @@
 #pragma once
 #include <vector>
 #include <memory>
-#include <mutex>
 #include "../scenes/Scene.h"
 #include "ModEngine.h"
+#include "../utils/MpscQueue.h"
 
 
 class StateMachine {
 public:
     StateMachine(AppContext& ctx);
-    ~StateMachine() = default;
+    ~StateMachine();
 
     void handle_event(SDL_Event& e);
     void update();
@@ -22,6 +22,10 @@ public:
 
     bool is_running() const { return !m_states.empty(); }
     size_t get_stack_size() const { return m_states.size(); }
+    // Debug counter: frames whose render() issued filesystem syscalls
+    // (through the accounted helpers), and how many in total.
+    uint64_t get_render_syscall_frames() const { return m_render_syscall_frames; }
+    uint64_t get_render_syscalls() const { return m_render_syscalls; }
     ModEngine& get_engine() { return m_engine; }
     AppContext& get_context() { return m_context; }
     
@@ -37,6 +41,9 @@ private:
         Action action;
         std::unique_ptr<Scene> scene;
     };
-    std::vector<PendingChange> m_pending_changes;
-    std::mutex m_pending_changes_mutex;
+    // Pushed from any thread (workers raise alerts), drained by the main loop.
+    MpscQueue<PendingChange> m_pending_changes;
+
+    uint64_t m_render_syscall_frames = 0;
+    uint64_t m_render_syscalls = 0;
 };
@@ -8,7 +8,7 @@
 #include "utils/Utils.h"
 #include "core/StateMachine.h"
 #include "core/ModEngine.h"
-#include "scenes/MainMenuScene.h"
+#include "scenes/LoadingScene.h"
 
 // ImGui Includes
 #include "imgui.h"
@@ -64,6 +64,9 @@ int main(int argc, char* argv[]) {
         ("mod-data",     po::value<std::string>(), "Path to extracted mod data directory (e.g., mod_data/)")
         ("config-file",  po::value<std::string>(), "Path to openmw.cfg file")
         ("config-dir",   po::value<std::string>(), "Directory for esmm configs (ini, mlox)")
+        ("scan-workers", po::value<int>(),         "Threads scanning mods and reading plugins at once (0 = auto, 1 = serial)")
+        ("scan-max-depth",   po::value<int>(),       "Deepest folder level searched for optional data in a mod (default 12)")
+        ("scan-max-entries", po::value<long long>(), "Most folder entries read while scanning one mod (default 200000)")
         ("quiet",                                  "Quieten down logging")
         ("verbose",                                "Enable verbose debug logging")
     ;
@@ -93,6 +96,9 @@ int main(int argc, char* argv[]) {
     ctx.path_openmw_cfg      = vm.count("config-file")  ? fs::path(vm["config-file"].as<std::string>()) : base_path / "openmw.cfg";
     ctx.exec_7zz             = vm.count("7zz")          ? fs::path(vm["7zz"].as<std::string>())          : base_path / "7zzs";
     ctx.path_mod_archives    = vm.count("mod-archives") ? fs::path(vm["mod-archives"].as<std::string>()) : base_path / "mods/";
+    ctx.scan_workers         = vm.count("scan-workers") ? vm["scan-workers"].as<int>() : 0;
+    ctx.scan_max_depth       = vm.count("scan-max-depth") ? vm["scan-max-depth"].as<int>() : 0;
+    ctx.scan_max_entries     = vm.count("scan-max-entries") ? vm["scan-max-entries"].as<long long>() : 0;
 
     SDL_DisplayMode dm;
     if (SDL_GetDesktopDisplayMode(0, &dm) != 0) {
@@ -166,7 +172,7 @@ int main(int argc, char* argv[]) {
 
     ctx.engine = &machine.get_engine(); 
 
-    machine.push_scene(std::make_unique<MainMenuScene>(machine));
+    machine.push_scene(std::make_unique<LoadingScene>(machine));
 
     // Framerate stuff.
     const int TARGET_FPS = 60;
@@ -221,6 +227,8 @@ int main(int argc, char* argv[]) {
     ImGui_ImplSDLRenderer2_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     ImGui::DestroyContext();
-    
+
+    // `machine` (and the engine in it) goes before `ctx`; don't leave it dangling.
+    ctx.engine = nullptr;
     return ctx.exit_code;
 }
@@ -1,52 +1,92 @@
 #include "ArchiveManager.h"
+#include "../utils/DirectorySource.h"
 #include <regex>
 #include <fstream>
 #include <iostream>
 #include <algorithm>
 
-void ArchiveManager::scan_archives(const fs::path& archive_dir, const fs::path& mod_data_dir) {
-    archives.clear();
-    if (!fs::exists(archive_dir)) return;
-
-    const std::vector<std::string> extensions = {".zip", ".7z", ".rar"};
-    for (const auto& entry : fs::directory_iterator(archive_dir)) {
-        if (!fs::is_regular_file(entry)) continue;
+static bool is_archive_file(const fs::path& path) {
+    static const std::vector<std::string> extensions = {".zip", ".7z", ".rar"};
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return std::find(extensions.begin(), extensions.end(), ext) != extensions.end();
+}
 
-        std::string ext = entry.path().extension().string();
-        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-        
-        bool is_archive = false;
-        for (const auto& supported_ext : extensions) {
-            if (ext == supported_ext) {
-                is_archive = true;
-                break;
-            }
-        }
-        if (!is_archive) continue;
-
-        ArchiveInfo info;
-        info.archive_path = entry.path();
-        info.name = cleanModName(entry.path().filename().string());
-        info.version = extractVersionString(entry.path().filename().string(), info.name);
-        info.target_data_path = mod_data_dir / info.name;
-
-        // Now, determine the status
-        fs::path marker_file = info.target_data_path / "esmm_archive.txt";
-        if (!fs::exists(info.target_data_path) || !fs::exists(marker_file)) {
-            info.status = ArchiveInfo::NEW;
-        } else {
-            std::ifstream file(marker_file.string());
-            std::string installed_archive_name;
-            if (std::getline(file, installed_archive_name)) {
-                if (installed_archive_name == info.archive_path.filename().string()) {
-                    info.status = ArchiveInfo::INSTALLED;
-                } else {
-                    info.status = ArchiveInfo::UPDATE_AVAILABLE;
-                }
-            }
+static ArchiveInfo::Status read_archive_status(const ArchiveInfo& info) {
+    fs::path marker_file = info.target_data_path / "esmm_archive.txt";
+    if (!fs::exists(info.target_data_path) || !fs::exists(marker_file)) {
+        return ArchiveInfo::NEW;
+    }
+    std::ifstream file(marker_file.string());
+    std::string installed_archive_name;
+    if (std::getline(file, installed_archive_name)) {
+        if (installed_archive_name == info.archive_path.filename().string()) {
+            return ArchiveInfo::INSTALLED;
         }
-        archives.push_back(info);
+        return ArchiveInfo::UPDATE_AVAILABLE;
     }
+    return ArchiveInfo::UNKNOWN;
+}
+
+static ArchiveInfo make_archive_info(const fs::path& archive_path, const fs::path& mod_data_dir) {
+    ArchiveInfo info;
+    info.archive_path = archive_path;
+    info.name = cleanModName(archive_path.filename().string());
+    info.version = extractVersionString(archive_path.filename().string(), info.name);
+    info.target_data_path = mod_data_dir / info.name;
+    info.status = read_archive_status(info);
+    return info;
+}
+
+static void sort_archives(std::vector<ArchiveInfo>& archives) {
     // Sort for consistent display
     std::sort(archives.begin(), archives.end(), [](const ArchiveInfo& a, const ArchiveInfo& b){ return a.name < b.name; });
 }
+
+void ArchiveManager::scan_archives(const fs::path& archive_dir, const fs::path& mod_data_dir,
+                                   const CancelToken& cancel, ProgressSink* progress) {
+    if (!fs::exists(archive_dir)) {
+        archives.clear();
+        return;
+    }
+
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(archive_dir)) {
+        if (!fs::is_regular_file(entry)) continue;
+        if (!is_archive_file(entry.path())) continue;
+        files.push_back(entry.path());
+    }
+    if (progress) progress->begin("Scanning archives", files.size());
+
+    std::vector<ArchiveInfo> scanned;
+    for (const auto& file : files) {
+        cancel.throw_if_cancelled();
+        scanned.push_back(make_archive_info(file, mod_data_dir));
+        if (progress) progress->advance();
+    }
+    sort_archives(scanned);
+    archives = std::move(scanned);
+}
+
+void ArchiveManager::update_archive(const fs::path& archive_path, const fs::path& mod_data_dir) {
+    archives.erase(std::remove_if(archives.begin(), archives.end(),
+        [&](const ArchiveInfo& a) { return a.archive_path == archive_path; }), archives.end());
+
+    if (is_archive_file(archive_path) && fs::is_regular_file(archive_path)) {
+        archives.push_back(make_archive_info(archive_path, mod_data_dir));
+        sort_archives(archives);
+    }
+}
+
+void ArchiveManager::refresh_status(const fs::path& target_data_path) {
+    for (auto& info : archives) {
+        if (info.target_data_path == target_data_path) info.status = read_archive_status(info);
+    }
+}
+
+bool ArchiveManager::preview_layout(const ArchiveInfo& archive, const fs::path& exec_7zz, ModDefinition& out) {
+    ArchiveListingSource listing(archive.target_data_path);
+    if (!listing.load(exec_7zz, archive.archive_path)) return false;
+    out = parse_mod_directory(archive.target_data_path, nullptr, &listing);
+    return true;
+}
@@ -2,7 +2,9 @@
 #include <string>
 #include <vector>
 #include <boost/filesystem.hpp>
+#include "../utils/Progress.h"
 #include "../utils/Utils.h"
+#include "ModManager.h"
 
 namespace fs = boost::filesystem;
 
@@ -19,8 +21,20 @@ struct ArchiveInfo {
 
 class ArchiveManager {
 public:
-    // Main function to scan archives and determine their status
-    void scan_archives(const fs::path& archive_dir, const fs::path& mod_data_dir);
+    // Main function to scan archives and determine their status. Throws
+    // OperationCancelled (leaving `archives` untouched) if cancelled.
+    void scan_archives(const fs::path& archive_dir, const fs::path& mod_data_dir,
+                       const CancelToken& cancel = CancelToken(), ProgressSink* progress = nullptr);
+
+    // Incremental updates driven by filesystem events.
+    // Re-reads one archive file (adding, refreshing or dropping its entry).
+    void update_archive(const fs::path& archive_path, const fs::path& mod_data_dir);
+    // Recomputes the status of archives that extract into `target_data_path`.
+    void refresh_status(const fs::path& target_data_path);
+
+    // Runs the mod layout rules on the archive's listing, as if it had been
+    // extracted to its target path. Returns false if it couldn't be listed.
+    static bool preview_layout(const ArchiveInfo& archive, const fs::path& exec_7zz, ModDefinition& out);
 
     // Public state for the UI
     std::vector<ArchiveInfo> archives;
@@ -41,8 +41,9 @@ std::unique_ptr<ConfigData> ConfigParser::read_config(const fs::path& cfg_path)
         }
     }
     
-    for(const auto& name : enabled_content) config_data->content_files.push_back({name, true, "Unknown"});
-    for(const auto& name : disabled_content) config_data->content_files.push_back({name, false, "Unknown"});
+    const StringId unknown = intern("Unknown");
+    for(const auto& name : enabled_content) config_data->content_files.push_back({intern(name), true, unknown});
+    for(const auto& name : disabled_content) config_data->content_files.push_back({intern(name), false, unknown});
 
     return config_data;
 }
@@ -83,8 +84,8 @@ bool ConfigParser::write_config(const fs::path& target_path, const fs::path& sou
         } else if (trimmed_line.rfind("content=", 0) == 0 || trimmed_line.rfind("#content=", 0) == 0) {
             if (!content_written) {
                 for (const auto& cf : data.content_files) {
-                    if (cf.enabled) dest_file << "content=" << cf.name << "\n";
-                    else dest_file << "#content=" << cf.name << "\n";
+                    if (cf.enabled) dest_file << "content=" << interned(cf.name) << "\n";
+                    else dest_file << "#content=" << interned(cf.name) << "\n";
                 }
                 content_written = true;
             }
@@ -101,8 +102,8 @@ bool ConfigParser::write_config(const fs::path& target_path, const fs::path& sou
     }
     if (!content_written) {
         for (const auto& cf : data.content_files) {
-            if (cf.enabled) dest_file << "content=" << cf.name << "\n";
-            else dest_file << "#content=" << cf.name << "\n";
+            if (cf.enabled) dest_file << "content=" << interned(cf.name) << "\n";
+            else dest_file << "#content=" << interned(cf.name) << "\n";
         }
     }
 
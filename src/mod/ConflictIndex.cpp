@@ -0,0 +1,176 @@
+#include "ConflictIndex.h"
+#include "../utils/HashIndex.h"
+#include "../utils/WorkerPool.h"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+namespace {
+
+// Shards are picked by the top bits of the key hash.
+const unsigned SHARD_BITS = 6;
+const size_t SHARD_COUNT = size_t(1) << SHARD_BITS;
+const uint32_t NIL = 0xFFFFFFFFu;
+
+struct Ref {
+    uint64_t hash;
+    uint32_t plugin;
+    uint32_t record;
+};
+
+// Orders record types alphabetically by their four characters.
+uint32_t type_order(uint32_t type) { return __builtin_bswap32(type); }
+
+size_t shard_of(uint64_t hash) { return static_cast<size_t>(hash >> (64 - SHARD_BITS)); }
+
+// Turns the refs sharing one hash (in load order) into conflicts. That is
+// nearly always a single key; true collisions are split apart by ID.
+void group_run(const std::vector<std::shared_ptr<const PluginRecords>>& records, const std::vector<Ref>& refs,
+               std::vector<char>& taken, std::vector<uint64_t>& digests, std::vector<RecordConflict>& out) {
+    taken.assign(refs.size(), 0);
+    for (size_t a = 0; a < refs.size(); ++a) {
+        if (taken[a]) continue;
+        const PluginRecords& lead_plugin = *records[refs[a].plugin];
+        const RecordEntry& lead = lead_plugin.records[refs[a].record];
+
+        RecordConflict conflict;
+        conflict.type = lead.type;
+        digests.clear();
+        const Ref* winner = &refs[a];
+        for (size_t b = a; b < refs.size(); ++b) {
+            if (taken[b]) continue;
+            const Ref& ref = refs[b];
+            const PluginRecords& plugin = *records[ref.plugin];
+            const RecordEntry& record = plugin.records[ref.record];
+            if (b != a && !same_record_key(lead_plugin, lead, plugin, record)) continue;
+            taken[b] = 1;
+            winner = &ref;
+            // A plugin repeating a record replaces its own earlier copy.
+            if (!conflict.plugins.empty() && conflict.plugins.back() == ref.plugin) {
+                digests.back() = record.digest;
+                continue;
+            }
+            conflict.plugins.push_back(ref.plugin);
+            digests.push_back(record.digest);
+        }
+        if (conflict.plugins.size() < 2) continue;
+
+        const PluginRecords& winning_plugin = *records[winner->plugin];
+        conflict.id = winning_plugin.id(winning_plugin.records[winner->record]);
+        conflict.identical = std::all_of(digests.begin(), digests.end(),
+                                         [&](uint64_t d) { return d == digests.front(); });
+        out.push_back(std::move(conflict));
+    }
+}
+
+} // namespace
+
+ConflictReport build_conflict_report(const std::vector<StringId>& plugins,
+                                     const std::vector<std::shared_ptr<const PluginRecords>>& records,
+                                     WorkerPool& pool, const CancelToken& cancel) {
+    auto start = std::chrono::steady_clock::now();
+    const size_t count = plugins.size();
+    ConflictReport report;
+    report.plugins = plugins;
+    report.stats.resize(count);
+
+    // 1. Hash every key once, counting how many each plugin puts in each shard.
+    std::vector<std::vector<uint64_t>> hashes(count);
+    std::vector<uint32_t> offsets(count * SHARD_COUNT, 0);
+    pool.parallel_for(count, [&](size_t p) {
+        if (cancel.is_cancelled()) return;
+        const PluginRecords& plugin = *records[p];
+        std::vector<uint64_t>& h = hashes[p];
+        h.resize(plugin.records.size());
+        for (size_t i = 0; i < h.size(); ++i) {
+            h[i] = record_key_hash(plugin.records[i], plugin.id_data(plugin.records[i]));
+            offsets[p * SHARD_COUNT + shard_of(h[i])]++;
+        }
+    });
+    cancel.throw_if_cancelled();
+
+    // 2. Turn the counts into each plugin's slice of every shard, and scatter.
+    // Slices follow load order, so every shard is in load order too.
+    std::vector<std::vector<Ref>> shards(SHARD_COUNT);
+    for (size_t s = 0; s < SHARD_COUNT; ++s) {
+        uint32_t total = 0;
+        for (size_t p = 0; p < count; ++p) {
+            uint32_t n = offsets[p * SHARD_COUNT + s];
+            offsets[p * SHARD_COUNT + s] = total;
+            total += n;
+        }
+        shards[s].resize(total);
+    }
+    pool.parallel_for(count, [&](size_t p) {
+        uint32_t* next = &offsets[p * SHARD_COUNT];
+        const std::vector<uint64_t>& h = hashes[p];
+        for (size_t i = 0; i < h.size(); ++i) {
+            size_t s = shard_of(h[i]);
+            shards[s][next[s]++] = Ref{h[i], static_cast<uint32_t>(p), static_cast<uint32_t>(i)};
+        }
+        std::vector<uint64_t>().swap(hashes[p]);
+    });
+
+    // 3. Index each shard on its own: a table from hash to the first ref
+    // with it (the table probes with the low bits; the shard used the high
+    // ones), and per-hash chains that keep load order. Only hashes that
+    // picked up a second ref are grouped.
+    std::vector<std::vector<RecordConflict>> found(SHARD_COUNT);
+    pool.parallel_for(SHARD_COUNT, [&](size_t s) {
+        if (cancel.is_cancelled()) return;
+        std::vector<Ref>& refs = shards[s];
+        HashIndex<uint64_t> heads;
+        heads.reserve(refs.size());
+        std::vector<uint32_t> next(refs.size(), NIL);
+        std::vector<uint32_t> tail(refs.size(), NIL); // last ref of each chain, by its head
+        std::vector<uint32_t> contested;
+        for (uint32_t i = 0; i < refs.size(); ++i) {
+            const uint64_t hash = refs[i].hash;
+            // Refs are chained by hash alone; group_run() splits true collisions.
+            uint32_t head = heads.find(hash, [](uint32_t) { return true; });
+            if (head == HashIndex<uint64_t>::NONE) {
+                heads.insert(hash, i);
+                tail[i] = i;
+                continue;
+            }
+            if (tail[head] == head) contested.push_back(head);
+            next[tail[head]] = i;
+            tail[head] = i;
+        }
+
+        std::vector<Ref> run;
+        std::vector<char> taken;
+        std::vector<uint64_t> digests;
+        for (uint32_t head : contested) {
+            run.clear();
+            for (uint32_t r = head; r != NIL; r = next[r]) run.push_back(refs[r]);
+            group_run(records, run, taken, digests, found[s]);
+        }
+        std::vector<Ref>().swap(refs);
+    });
+    cancel.throw_if_cancelled();
+
+    // 4. Merge, order for display, and tally per plugin.
+    size_t total = 0;
+    for (const auto& f : found) total += f.size();
+    report.conflicts.reserve(total);
+    for (auto& f : found) {
+        std::move(f.begin(), f.end(), std::back_inserter(report.conflicts));
+    }
+    std::sort(report.conflicts.begin(), report.conflicts.end(), [](const RecordConflict& a, const RecordConflict& b) {
+        if (a.plugins.back() != b.plugins.back()) return a.plugins.back() < b.plugins.back();
+        if (a.type != b.type) return type_order(a.type) < type_order(b.type);
+        return a.id < b.id;
+    });
+    for (size_t p = 0; p < count; ++p) {
+        report.stats[p].records = records[p]->records.size();
+        report.records += records[p]->records.size();
+    }
+    for (const auto& conflict : report.conflicts) {
+        report.stats[conflict.plugins.back()].wins++;
+        for (size_t i = 0; i + 1 < conflict.plugins.size(); ++i) report.stats[conflict.plugins[i]].overridden++;
+    }
+
+    report.build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "PluginRecords.h"
+#include "../utils/StringPool.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class WorkerPool;
+
+// A record that more than one enabled plugin defines.
+struct RecordConflict {
+    uint32_t type;
+    std::string id;
+    std::vector<uint32_t> plugins; // indices into ConflictReport::plugins, load order; the last one wins
+    bool identical = false;        // every plugin's version is byte-for-byte the same
+};
+
+struct PluginConflictStats {
+    size_t records = 0;    // identifiable records in the plugin
+    size_t wins = 0;       // contested records this plugin has the final say on
+    size_t overridden = 0; // of its records, how many a later plugin replaces
+};
+
+struct ConflictReport {
+    std::vector<StringId> plugins;           // enabled plugins that were checked, in load order
+    std::vector<PluginConflictStats> stats;  // per plugin
+    std::vector<StringId> unreadable;        // enabled, but missing or not a TES3 plugin
+    std::vector<RecordConflict> conflicts;   // by winning plugin, then type and ID
+    size_t records = 0;                      // total records indexed
+    size_t plugins_read = 0;                 // plugins whose cached digests were stale
+    double build_ms = 0.0;
+};
+
+// Indexes every record of `records` (one per plugin, in load order) by its
+// (type, case-insensitive ID) and reports each key more than one plugin
+// defines. Keys are hashed once per plugin in parallel, scattered into
+// hash-range shards, and each shard is grouped independently on the pool.
+ConflictReport build_conflict_report(const std::vector<StringId>& plugins,
+                                     const std::vector<std::shared_ptr<const PluginRecords>>& records,
+                                     WorkerPool& pool, const CancelToken& cancel = CancelToken());
@@ -0,0 +1,94 @@
+#include "ContentSorter.h"
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <queue>
+#include <string>
+#include <unordered_map>
+
+static std::string lowercase(const std::string& s) {
+    std::string out(s);
+    std::transform(out.begin(), out.end(), out.begin(), ::tolower);
+    return out;
+}
+
+std::vector<uint32_t> sort_by_masters(const std::vector<StringId>& plugins,
+                                      const std::vector<std::vector<StringId>>& masters,
+                                      ContentSortReport* report) {
+    const uint32_t count = static_cast<uint32_t>(plugins.size());
+    ContentSortReport local_report;
+    if (!report) report = &local_report;
+    *report = ContentSortReport();
+
+    // Case-insensitive name -> position; the first occurrence wins.
+    std::unordered_map<std::string, uint32_t> position;
+    position.reserve(count * 2);
+    for (uint32_t i = 0; i < count; ++i) position.emplace(lowercase(interned(plugins[i])), i);
+
+    // Sort key: the base game masters first, in this order, then everything
+    // by its current position.
+    static const char* const PINNED[] = {"morrowind.esm", "tribunal.esm", "bloodmoon.esm"};
+    const uint64_t pinned_count = sizeof(PINNED) / sizeof(PINNED[0]);
+    std::vector<uint64_t> key(count);
+    for (uint32_t i = 0; i < count; ++i) key[i] = pinned_count + i;
+    for (uint64_t p = 0; p < pinned_count; ++p) {
+        auto it = position.find(PINNED[p]);
+        if (it != position.end()) key[it->second] = p;
+    }
+
+    // Edges master -> dependent, as a flat adjacency list.
+    std::vector<uint32_t> indegree(count, 0);
+    std::vector<uint32_t> edge_begin(count + 1, 0);
+    std::vector<uint32_t> edge_to;
+    std::vector<std::pair<uint32_t, uint32_t>> edges; // (master, dependent)
+    for (uint32_t i = 0; i < count && i < masters.size(); ++i) {
+        for (StringId master : masters[i]) {
+            auto it = position.find(lowercase(interned(master)));
+            if (it == position.end()) {
+                report->missing_masters.emplace_back(plugins[i], master);
+                continue;
+            }
+            if (it->second == i) continue; // a plugin naming itself is harmless
+            edges.emplace_back(it->second, i);
+        }
+    }
+    for (const auto& e : edges) edge_begin[e.first + 1]++;
+    for (uint32_t i = 0; i < count; ++i) edge_begin[i + 1] += edge_begin[i];
+    edge_to.resize(edges.size());
+    std::vector<uint32_t> fill(edge_begin.begin(), edge_begin.end() - 1);
+    for (const auto& e : edges) {
+        edge_to[fill[e.first]++] = e.second;
+        indegree[e.second]++;
+    }
+
+    // Kahn's algorithm, always emitting the ready plugin with the smallest key.
+    typedef std::pair<uint64_t, uint32_t> Ready;
+    std::priority_queue<Ready, std::vector<Ready>, std::greater<Ready>> ready;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (indegree[i] == 0) ready.emplace(key[i], i);
+    }
+    std::vector<uint32_t> order;
+    order.reserve(count);
+    std::vector<char> placed(count, 0);
+    while (!ready.empty()) {
+        uint32_t i = ready.top().second;
+        ready.pop();
+        order.push_back(i);
+        placed[i] = 1;
+        for (uint32_t e = edge_begin[i]; e < edge_begin[i + 1]; ++e) {
+            if (--indegree[edge_to[e]] == 0) ready.emplace(key[edge_to[e]], edge_to[e]);
+        }
+    }
+
+    // Anything left is in (or behind) a master cycle.
+    for (uint32_t i = 0; i < count; ++i) {
+        if (placed[i]) continue;
+        order.push_back(i);
+        report->cycle.push_back(plugins[i]);
+    }
+
+    for (uint32_t n = 0; n < count; ++n) {
+        if (order[n] != n) report->moved++;
+    }
+    return order;
+}
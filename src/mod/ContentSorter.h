@@ -0,0 +1,23 @@
+#pragma once
+#include "../utils/StringPool.h"
+#include <cstdint>
+#include <vector>
+
+// What the native content sorter had to work around.
+struct ContentSortReport {
+    size_t moved = 0;                                           // plugins whose position changed
+    std::vector<std::pair<StringId, StringId>> missing_masters; // (plugin, master not in the list)
+    std::vector<StringId> cycle;                                // plugins left in a master cycle
+};
+
+// Stable topological sort of a content list by its plugins' masters.
+// `masters[i]` are the masters of `plugins[i]` (from their TES3 headers);
+// names match case-insensitively. Every plugin loads after its masters;
+// beyond that the current order is kept as far as the dependencies allow
+// (the result is the lexicographically smallest valid order by current
+// position), and Morrowind/Tribunal/Bloodmoon always come first.
+// Returns the new order as indices into `plugins`. Plugins caught in a
+// cycle keep their relative order at the end and are listed in the report.
+std::vector<uint32_t> sort_by_masters(const std::vector<StringId>& plugins,
+                                      const std::vector<std::vector<StringId>>& masters,
+                                      ContentSortReport* report = nullptr);
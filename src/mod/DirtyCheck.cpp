@@ -0,0 +1,210 @@
+#include "DirtyCheck.h"
+#include "../utils/HashIndex.h"
+#include "../utils/WorkerPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+const uint32_t NIL = 0xFFFFFFFFu;
+
+uint32_t fourcc(const char* name) {
+    uint32_t value;
+    std::memcpy(&value, name, sizeof(value));
+    return value;
+}
+
+const uint32_t TYPE_CELL = fourcc("CELL");
+const uint32_t TYPE_DIAL = fourcc("DIAL");
+
+std::string lowercase(const std::string& s) {
+    std::string out(s);
+    std::transform(out.begin(), out.end(), out.begin(), ::tolower);
+    return out;
+}
+
+uint64_t mix(uint64_t h, uint64_t v) {
+    return h ^ (v + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2));
+}
+
+// Index of one master's records by key. A key defined twice resolves to its
+// last record, as in the game.
+class KeyTable {
+public:
+    explicit KeyTable(const PluginRecords& records) : m_records(records) {
+        m_index.reserve(records.records.size());
+        // Backwards, so the first record indexed for a key is its last one.
+        for (uint32_t i = static_cast<uint32_t>(records.records.size()); i-- > 0;) {
+            const RecordEntry& record = records.records[i];
+            uint64_t hash = record_key_hash(record, records.id_data(record));
+            if (find(records, record, hash) == NIL) m_index.insert(hash, i);
+        }
+    }
+
+    // Index of the master's version of `record` (a record of `owner`), or NIL.
+    uint32_t find(const PluginRecords& owner, const RecordEntry& record, uint64_t hash) const {
+        return m_index.find(hash, [&](uint32_t i) {
+            return same_record_key(m_records, m_records.records[i], owner, record);
+        });
+    }
+
+private:
+    const PluginRecords& m_records;
+    HashIndex<uint64_t> m_index;
+};
+
+struct Master {
+    StringId name;
+    const PluginRecords* records = nullptr; // null if not available
+    const KeyTable* table = nullptr;
+};
+
+std::shared_ptr<const PluginDirtyReport> check_plugin(const DirtyCheckInput& input, const std::vector<Master>& masters) {
+    auto report = std::make_shared<PluginDirtyReport>();
+    report->plugin = input.plugin;
+    report->digest = input.records->digest;
+    for (const auto& master : masters) {
+        if (!master.records) report->missing_masters.push_back(master.name);
+    }
+
+    const PluginRecords& own = *input.records;
+    for (uint32_t r = 0; r < own.records.size(); ++r) {
+        const RecordEntry& record = own.records[r];
+        uint64_t hash = record_key_hash(record, own.id_data(record));
+        for (size_t m = masters.size(); m-- > 0;) {
+            if (!masters[m].table) continue;
+            uint32_t found = masters[m].table->find(own, record, hash);
+            if (found == NIL) continue;
+
+            const RecordEntry& theirs = masters[m].records->records[found];
+            DirtyEdit edit;
+            if ((record.flags & RecordEntry::DELETED) && !(theirs.flags & RecordEntry::DELETED)) {
+                edit.kind = DirtyEdit::DELETED_RECORD;
+            } else if (record.digest == theirs.digest && record.type != TYPE_DIAL) {
+                // A DIAL that repeats its master is how a plugin adds INFOs
+                // to an existing topic, so it is never reported.
+                edit.kind = DirtyEdit::IDENTICAL_TO_MASTER;
+            } else {
+                break;
+            }
+            edit.type = record.type;
+            edit.record = r;
+            edit.id = own.id(record);
+            edit.master = masters[m].name;
+            report->edits.push_back(std::move(edit));
+            break;
+        }
+    }
+
+    // FRMR's top byte names the master that placed a reference (0 = this plugin).
+    for (const DeletedReference& ref : own.deleted_refs) {
+        uint32_t master = ref.master_index();
+        if (master == 0 || master > masters.size()) continue;
+        DirtyEdit edit;
+        edit.kind = DirtyEdit::DELETED_REFERENCE;
+        edit.type = TYPE_CELL;
+        edit.id = own.id(own.records[ref.cell]);
+        edit.object = own.id(ref);
+        edit.refnum = ref.refnum & 0x00FFFFFFu;
+        edit.record = ref.cell;
+        edit.master = masters[master - 1].name;
+        report->edits.push_back(std::move(edit));
+    }
+
+    std::sort(report->edits.begin(), report->edits.end(), [](const DirtyEdit& a, const DirtyEdit& b) {
+        if (a.kind != b.kind) return a.kind < b.kind;
+        if (a.type != b.type) return record_type_name(a.type) < record_type_name(b.type);
+        if (a.id != b.id) return a.id < b.id;
+        return a.refnum < b.refnum;
+    });
+    for (const auto& edit : report->edits) {
+        if (edit.kind == DirtyEdit::IDENTICAL_TO_MASTER) report->identical++;
+        else if (edit.kind == DirtyEdit::DELETED_RECORD) report->deleted_records++;
+        else report->deleted_refs++;
+    }
+    return report;
+}
+
+} // namespace
+
+DirtyReport DirtyChecker::check(const std::vector<DirtyCheckInput>& plugins,
+                                const std::unordered_map<std::string, std::shared_ptr<const PluginRecords>>& available,
+                                WorkerPool& pool, const CancelToken& cancel) {
+    auto start = std::chrono::steady_clock::now();
+    DirtyReport report;
+
+    // 1. Resolve every plugin's masters and the key its result is kept under;
+    // note which masters need indexing for the plugins not seen before.
+    struct Job {
+        std::vector<Master> masters;
+        uint64_t key = 0;
+        std::shared_ptr<const PluginDirtyReport> result;
+    };
+    std::vector<Job> jobs(plugins.size());
+    std::unordered_map<const PluginRecords*, std::unique_ptr<KeyTable>> tables;
+    std::vector<const PluginRecords*> needed;
+    std::vector<size_t> stale;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < plugins.size(); ++i) {
+            Job& job = jobs[i];
+            job.key = mix(plugins[i].records->digest, plugins[i].plugin);
+            for (const auto& name : plugins[i].masters) {
+                std::string lower = lowercase(name);
+                Master master;
+                master.name = intern(name);
+                auto it = available.find(lower);
+                if (it != available.end() && it->second) master.records = it->second.get();
+                job.key = mix(job.key, master.records ? master.records->digest : std::hash<std::string>()(lower));
+                job.masters.push_back(master);
+            }
+
+            auto cached = m_results.find(job.key);
+            if (cached != m_results.end()) {
+                job.result = cached->second;
+                report.reused++;
+                continue;
+            }
+            stale.push_back(i);
+            for (const auto& master : job.masters) {
+                if (master.records && tables.emplace(master.records, nullptr).second) needed.push_back(master.records);
+            }
+        }
+    }
+
+    // 2. Index each master once, in parallel.
+    std::vector<std::unique_ptr<KeyTable>> built(needed.size());
+    pool.parallel_for(needed.size(), [&](size_t n) {
+        if (cancel.is_cancelled()) return;
+        built[n].reset(new KeyTable(*needed[n]));
+    });
+    cancel.throw_if_cancelled();
+    for (size_t n = 0; n < needed.size(); ++n) tables[needed[n]] = std::move(built[n]);
+    for (size_t i : stale) {
+        for (auto& master : jobs[i].masters) {
+            if (master.records) master.table = tables[master.records].get();
+        }
+    }
+
+    // 3. Check the plugins, in parallel.
+    pool.parallel_for(stale.size(), [&](size_t n) {
+        if (cancel.is_cancelled()) return;
+        jobs[stale[n]].result = check_plugin(plugins[stale[n]], jobs[stale[n]].masters);
+    });
+    cancel.throw_if_cancelled();
+
+    // Keep just this check's results, so the memo never outgrows the load order.
+    std::unordered_map<uint64_t, std::shared_ptr<const PluginDirtyReport>> kept;
+    for (const auto& job : jobs) {
+        kept[job.key] = job.result;
+        report.plugins.push_back(job.result);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_results.swap(kept);
+    }
+
+    report.check_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "PluginRecords.h"
+#include "../utils/StringPool.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class WorkerPool;
+
+// One dirty edit: something a plugin changes in a master that it shouldn't.
+struct DirtyEdit {
+    enum Kind : uint8_t {
+        IDENTICAL_TO_MASTER, // repeats the master's version of a record unchanged (ITM)
+        DELETED_RECORD,      // deletes a record the master defines
+        DELETED_REFERENCE,   // deletes a reference the master placed in a cell
+    };
+
+    Kind kind;
+    uint32_t type;       // record type; CELL for references
+    std::string id;      // record ID; for references, the cell
+    std::string object;  // DELETED_REFERENCE: what the reference placed
+    uint32_t refnum = 0; // DELETED_REFERENCE: index within the master
+    uint32_t record = 0; // the plugin's PluginRecords::records entry (the CELL, for references)
+    StringId master;     // the master the edit is against
+};
+
+struct PluginDirtyReport {
+    StringId plugin;
+    uint64_t digest = 0;          // PluginRecords::digest of the plugin as checked
+    std::vector<DirtyEdit> edits; // by kind, then type and ID
+    size_t identical = 0;
+    size_t deleted_records = 0;
+    size_t deleted_refs = 0;
+    std::vector<StringId> missing_masters; // not available, so not compared against
+
+    bool is_dirty() const { return !edits.empty(); }
+};
+
+struct DirtyReport {
+    std::vector<std::shared_ptr<const PluginDirtyReport>> plugins; // every checked plugin, in load order
+    std::vector<StringId> unreadable; // enabled, but missing or not a TES3 plugin
+    size_t reused = 0;                // plugin results carried over from an earlier check
+    double check_ms = 0.0;
+};
+
+// A plugin to check, with its masters as named in its header.
+struct DirtyCheckInput {
+    StringId plugin;
+    std::shared_ptr<const PluginRecords> records;
+    std::vector<std::string> masters;
+};
+
+// Compares each plugin's records with its masters' by content digest. A
+// record is checked against the last master (in header order) that defines
+// it, which is the version the plugin actually overrides. Results are kept
+// per plugin, keyed by the plugin's digest and its masters', so re-checking
+// only redoes plugins whose own records or masters changed.
+class DirtyChecker {
+public:
+    // `available` holds the records of every plugin that may be a master,
+    // keyed by lower-cased file name. Plugins run in parallel on `pool`.
+    DirtyReport check(const std::vector<DirtyCheckInput>& plugins,
+                      const std::unordered_map<std::string, std::shared_ptr<const PluginRecords>>& available,
+                      WorkerPool& pool, const CancelToken& cancel = CancelToken());
+
+private:
+    std::mutex m_mutex;
+    std::unordered_map<uint64_t, std::shared_ptr<const PluginDirtyReport>> m_results;
+};
@@ -1,8 +1,15 @@
 #include "ModManager.h"
+#include "../utils/WorkerPool.h"
+#include "../utils/DirListing.h"
+#include "../utils/DirectorySource.h"
 #include <iostream>
 #include <algorithm>
 #include <regex>
 #include <set>
+#include <map>
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
 
 // Uncomment this line to get verbose output from the parser to the console
 // #define DEBUG_PARSER
@@ -11,73 +18,118 @@
 // HELPER FUNCTIONS
 // =============================================================================
 
-bool is_plugin_file(const fs::path& path) {
-    if (!fs::is_regular_file(path)) return false;
-    std::string ext = path.extension().string();
+bool is_plugin_name(const std::string& filename) {
+    std::string ext = fs::path(filename).extension().string();
     std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
     return ext == ".esp" || ext == ".esm" || ext == ".omwscripts" || ext == ".omwaddon";
 }
 
+bool is_plugin_file(const fs::path& path) {
+    if (!fs::is_regular_file(path)) return false;
+    return is_plugin_name(path.filename().string());
+}
+
+// All classifiers below work on cached single-pass listings, so every
+// directory in a mod is opened once and types come from d_type, not stat().
+
+static std::vector<std::string> plugins_in_listing(const DirListing& listing) {
+    std::vector<std::string> plugins;
+    for (const auto& entry : listing.entries) {
+        if (entry.type == DirEntry::FILE && is_plugin_name(entry.name)) {
+            plugins.push_back(entry.name);
+        }
+    }
+    return plugins;
+}
+
 // Now correctly handles the "Data Files" case without flagging the parent.
-static bool is_data_directory(const fs::path& dir_path) {
-    if (!fs::is_directory(dir_path)) return false;
-    try {
-        for (const auto& entry : fs::directory_iterator(dir_path)) {
-            if (fs::is_directory(entry)) {
-                std::string dirname = entry.path().filename().string();
-                std::transform(dirname.begin(), dirname.end(), dirname.begin(), ::tolower);
-                // A directory is a data directory if it CONTAINS these folders.
-                if (dirname == "meshes" || dirname == "textures") return true;
-            } else if (is_plugin_file(entry.path())) {
-                return true;
-            }
+static bool is_data_directory(DirectoryCache& cache, const fs::path& dir_path) {
+    const DirListing& listing = cache.list(dir_path);
+    for (const auto& entry : listing.entries) {
+        if (entry.type == DirEntry::DIRECTORY) {
+            std::string dirname = entry.name;
+            std::transform(dirname.begin(), dirname.end(), dirname.begin(), ::tolower);
+            // A directory is a data directory if it CONTAINS these folders.
+            if (dirname == "meshes" || dirname == "textures") return true;
+        } else if (entry.type == DirEntry::FILE && is_plugin_name(entry.name)) {
+            return true;
         }
-    } catch (const fs::filesystem_error&) {}
+    }
     return false;
 }
 
 // Helper to find all plugins within a given path (non-recursive)
-std::vector<std::string> find_plugins_in_path(const fs::path& path) {
-    std::vector<std::string> plugins;
-    if (!fs::is_directory(path)) return plugins;
-    try {
-        for(const auto& p_entry : fs::directory_iterator(path)) {
-            if(is_plugin_file(p_entry.path())) {
-                plugins.push_back(p_entry.path().filename().string());
-            }
-        }
-    } catch (const fs::filesystem_error&) {}
-    return plugins;
+std::vector<std::string> find_plugins_in_path(const fs::path& path, DirectorySource* source) {
+    DirListing listing;
+    (source ? *source : RealDirectorySource::instance()).list(path, listing);
+    return plugins_in_listing(listing);
 }
 
-// New recursive helper to find optional data paths
-static void find_optional_data_paths_recursive(const fs::path& current_path, std::vector<fs::path>& found_paths) {
-    if (is_data_directory(current_path)) {
+// State shared across one mod's optional-folder search.
+struct OptionalSearch {
+    DirectoryCache& cache;
+    const ModScanLimits& limits;
+    ModScanStats& stats;
+    std::set<std::pair<uint64_t, uint64_t>> visited; // (dev, ino) of every directory entered
+};
+
+// New recursive helper to find optional data paths. Bounded by depth and by
+// entries read, and refuses to enter a directory twice (symlink loops).
+static void find_optional_data_paths_recursive(OptionalSearch& search, const fs::path& current_path, uint64_t dev,
+                                               uint64_t ino, int depth, std::vector<fs::path>& found_paths) {
+    if (ino != 0 && !search.visited.insert(std::make_pair(dev, ino)).second) {
+        search.stats.cycles++;
+        return;
+    }
+    if (depth > search.limits.max_depth || search.cache.entries_read() >= search.limits.max_entries ||
+        search.limits.cancel.is_cancelled()) {
+        search.stats.truncated = true;
+        return;
+    }
+    if (is_data_directory(search.cache, current_path)) {
         found_paths.push_back(current_path);
         return; // Found a valid data path, stop recursing down this branch.
     }
-    try {
-        for (const auto& entry : fs::directory_iterator(current_path)) {
-            if (fs::is_directory(entry.path())) {
-                find_optional_data_paths_recursive(entry.path(), found_paths);
-            }
-        }
-    } catch (const fs::filesystem_error&) {}
+    // Copy the entries out: recursing may grow the cache while we iterate.
+    std::vector<DirEntry> subdirs;
+    for (const auto& entry : search.cache.list(current_path).entries) {
+        if (entry.type == DirEntry::DIRECTORY) subdirs.push_back(entry);
+    }
+    for (const auto& entry : subdirs) {
+        find_optional_data_paths_recursive(search, current_path / entry.name, entry.dev ? entry.dev : dev, entry.ino,
+                                           depth + 1, found_paths);
+    }
 }
 
 // --- THE FINAL, RULE-BASED PARSER ---
-ModDefinition parse_mod_directory(const fs::path& mod_root_path) {
+ModDefinition parse_mod_directory(const fs::path& mod_root_path, std::vector<ListedDir>* listed_dirs, DirectorySource* source,
+                                  const ModScanLimits* limits, ModScanStats* stats) {
+    static const ModScanLimits default_limits;
+    ModScanStats local_stats;
+    if (!limits) limits = &default_limits;
+    if (!stats) stats = &local_stats;
+    auto start_time = std::chrono::steady_clock::now();
+    FsCounters start_counters = fs_thread_counters_snapshot();
+
     ModDefinition mod;
     mod.name = mod_root_path.filename().string();
     mod.root_path = mod_root_path;
     std::set<fs::path> processed_paths;
 
+    DirectoryCache cache(source);
+    std::vector<std::string> root_subdirs;
+    std::map<std::string, DirEntry> root_dir_entries;
+    for (const auto& entry : cache.list(mod_root_path).entries) {
+        if (entry.type == DirEntry::DIRECTORY) {
+            root_subdirs.push_back(entry.name);
+            root_dir_entries[entry.name] = entry;
+        }
+    }
+
     // --- RULE 1: Numbered Groups ---
+    static const std::regex num_pattern("^(\\d+)\\s*(.*)");
     std::map<int, ModOptionGroup> numbered_groups;
-    for (const auto& entry : fs::directory_iterator(mod_root_path)) {
-        if (!fs::is_directory(entry.path())) continue;
-        std::string dirname = entry.path().filename().string();
-        std::regex num_pattern("^(\\d+)\\s*(.*)");
+    for (const auto& dirname : root_subdirs) {
         std::smatch match;
         if (std::regex_match(dirname, match, num_pattern)) {
             int group_num = std::stoi(match[1].str());
@@ -87,8 +139,9 @@ ModDefinition parse_mod_directory(const fs::path& mod_root_path) {
                 numbered_groups[group_num].type = ModOptionGroup::SINGLE_CHOICE;
                 numbered_groups[group_num].required = (group_num == 0);
             }
-            numbered_groups[group_num].options.emplace_back(ModOption{name_part, entry.path(), find_plugins_in_path(entry.path())});
-            processed_paths.insert(entry.path());
+            fs::path option_path = mod_root_path / dirname;
+            numbered_groups[group_num].options.emplace_back(ModOption{name_part, option_path, plugins_in_listing(cache.list(option_path))});
+            processed_paths.insert(option_path);
         }
     }
     for (const auto& pair : numbered_groups) mod.option_groups.push_back(pair.second);
@@ -96,9 +149,9 @@ ModDefinition parse_mod_directory(const fs::path& mod_root_path) {
     // --- RULE 2 & 3: Main `Data Files` or Root as Main ---
     fs::path main_data_path;
     fs::path root_data_files = mod_root_path / "Data Files";
-    if (fs::exists(root_data_files) && is_data_directory(root_data_files)) {
+    if (std::find(root_subdirs.begin(), root_subdirs.end(), "Data Files") != root_subdirs.end() && is_data_directory(cache, root_data_files)) {
         main_data_path = root_data_files;
-    } else if (is_data_directory(mod_root_path)) {
+    } else if (is_data_directory(cache, mod_root_path)) {
         main_data_path = mod_root_path;
     }
 
@@ -107,17 +160,27 @@ ModDefinition parse_mod_directory(const fs::path& mod_root_path) {
         main_group.name = "Main";
         main_group.type = ModOptionGroup::MULTIPLE_CHOICE;
         main_group.required = true;
-        main_group.options.emplace_back(ModOption{main_data_path.filename().string(), main_data_path, find_plugins_in_path(main_data_path), true});
+        main_group.options.emplace_back(ModOption{main_data_path.filename().string(), main_data_path, plugins_in_listing(cache.list(main_data_path)), true});
         mod.option_groups.insert(mod.option_groups.begin(), main_group); // Add to the front
         processed_paths.insert(main_data_path);
         processed_paths.insert(mod_root_path); // Mark root as processed if it was the main path
     }
 
     // --- RULE 4: Recursive Search for Optionals ---
+    OptionalSearch search{cache, *limits, *stats, {}};
+    uint64_t root_dev = 0;
+    struct stat root_st;
+    if (!source && stat_path(mod_root_path, root_st)) {
+        root_dev = static_cast<uint64_t>(root_st.st_dev);
+        search.visited.insert(std::make_pair(root_dev, static_cast<uint64_t>(root_st.st_ino)));
+    }
     std::vector<fs::path> optional_paths;
-    for (const auto& entry : fs::directory_iterator(mod_root_path)) {
-        if (fs::is_directory(entry.path()) && processed_paths.find(entry.path()) == processed_paths.end()) {
-            find_optional_data_paths_recursive(entry.path(), optional_paths);
+    for (const auto& dirname : root_subdirs) {
+        fs::path sub_path = mod_root_path / dirname;
+        if (processed_paths.find(sub_path) == processed_paths.end()) {
+            const DirEntry& entry = root_dir_entries[dirname];
+            find_optional_data_paths_recursive(search, sub_path, entry.dev ? entry.dev : root_dev, entry.ino, 1,
+                                               optional_paths);
         }
     }
     
@@ -127,17 +190,19 @@ ModDefinition parse_mod_directory(const fs::path& mod_root_path) {
         optional_group.type = ModOptionGroup::MULTIPLE_CHOICE;
         for (const auto& path : optional_paths) {
             std::string name = path.lexically_relative(mod_root_path).string();
-            optional_group.options.emplace_back(ModOption{name, path, find_plugins_in_path(path)});
+            optional_group.options.emplace_back(ModOption{name, path, plugins_in_listing(cache.list(path))});
         }
         mod.option_groups.push_back(optional_group);
     }
-    
-    // Set all parent pointers after the groups vector is finalized.
-    for (auto& group : mod.option_groups) {
-        for (auto& option : group.options) {
-            option.parent_group = &group;
-        }
-    }
+
+    if (listed_dirs) *listed_dirs = cache.listed_dirs();
+
+    stats->root = mod_root_path;
+    stats->dirs_read = cache.dirs_read();
+    stats->entries_read = cache.entries_read();
+    stats->stats = (fs_thread_counters_snapshot() - start_counters).stats;
+    stats->wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+
     return mod;
 }
 
@@ -145,101 +210,163 @@ ModDefinition parse_mod_directory(const fs::path& mod_root_path) {
 // MOD MANAGER CLASS IMPLEMENTATION
 // =============================================================================
 
-void ModManager::scan_mods(const fs::path& mod_data_path) {
-    mod_definitions.clear();
+void ModManager::scan_mods(const fs::path& mod_data_path, WorkerPool* pool) {
+    mod_store.clear();
+    rebuild_path_index();
     if (!fs::exists(mod_data_path) || !fs::is_directory(mod_data_path)) {
         return;
     }
+    std::vector<fs::path> mod_dirs;
     for (const auto& entry : fs::directory_iterator(mod_data_path)) {
-        if (fs::is_directory(entry.path())) {
-            try {
-                mod_definitions.push_back(parse_mod_directory(entry.path()));
-            } catch (const std::exception& e) {
-                std::cerr << "Error parsing mod " << entry.path() << ": " << e.what() << std::endl;
-            }
+        if (fs::is_directory(entry.path())) mod_dirs.push_back(entry.path());
+    }
+    // Directory iteration order is filesystem-defined; fix it so results are stable.
+    std::sort(mod_dirs.begin(), mod_dirs.end());
+
+    std::vector<ModDefinition> parsed(mod_dirs.size());
+    std::vector<char> ok(mod_dirs.size(), 0);
+    auto parse_one = [&](size_t i) {
+        try {
+            parsed[i] = parse_mod_directory(mod_dirs[i]);
+            ok[i] = 1;
+        } catch (const std::exception& e) {
+            std::cerr << "Error parsing mod " << mod_dirs[i] << ": " << e.what() << std::endl;
         }
+    };
+    if (pool) {
+        pool->parallel_for(mod_dirs.size(), parse_one);
+    } else {
+        for (size_t i = 0; i < mod_dirs.size(); ++i) parse_one(i);
     }
+
+    std::vector<ModDefinition> mods;
+    for (size_t i = 0; i < mod_dirs.size(); ++i) {
+        if (ok[i]) mods.push_back(std::move(parsed[i]));
+    }
+    set_mods(mods);
+}
+
+static std::unordered_set<StringId> intern_paths(const std::vector<fs::path>& paths) {
+    std::unordered_set<StringId> ids;
+    for (const auto& p : paths) ids.insert(intern(p.string()));
+    return ids;
+}
+
+static void sync_mod_from_data_set(ModStore& store, uint32_t mod, const std::unordered_set<StringId>& data_set) {
+    bool is_mod_active = false;
+    for (uint32_t o = store.mod_options_begin(mod); o < store.mod_options_end(mod); ++o) {
+        // Check if this option's path is in the active set
+        bool active = data_set.count(store.option_path_id(o)) > 0;
+        store.set_option_enabled(o, active);
+        is_mod_active |= active;
+    }
+    store.set_mod_enabled(mod, is_mod_active);
 }
 
 void ModManager::sync_ui_state_from_active_lists() {
-    std::set<std::string> data_set;
-    for(const auto& p : active_data_paths) data_set.insert(p.string());
-
-    for (auto& mod : mod_definitions) {
-        bool is_mod_active = false;
-        for (auto& group : mod.option_groups) {
-            for (auto& option : group.options) {
-                // Check if this option's path is in the active set
-                if (data_set.count(option.path.string())) {
-                    option.enabled = true;
-                    is_mod_active = true;
-                } else {
-                    option.enabled = false;
-                }
-            }
-        }
-        mod.enabled = is_mod_active;
+    const std::unordered_set<StringId> data_set = intern_paths(active_data_paths);
+    for (uint32_t m = 0; m < mod_store.mod_count(); ++m) {
+        sync_mod_from_data_set(mod_store, m, data_set);
     }
 }
 
+void ModManager::sync_ui_state_for(uint32_t mod) {
+    sync_mod_from_data_set(mod_store, mod, intern_paths(active_data_paths));
+}
+
+void ModManager::set_mods(const std::vector<ModDefinition>& mods) {
+    mod_store.assign(mods);
+    rebuild_path_index();
+    plugin_index.sync_mods(mod_store);
+    m_lists_consistent = false;
+}
+
+void ModManager::rebuild_path_index() {
+    m_mod_roots.clear();
+    m_option_paths.clear();
+    for (uint32_t m = 0; m < mod_store.mod_count(); ++m) {
+        m_mod_roots.insert(mod_store.mod_root(m), m);
+    }
+    for (uint32_t o = 0; o < mod_store.option_count(); ++o) {
+        // First owner wins, matching the old linear search order.
+        if (m_option_paths.find(mod_store.option_path(o))) continue;
+        m_option_paths.insert(mod_store.option_path(o), o);
+    }
+}
+
+uint32_t ModManager::find_mod_owning(const fs::path& path) const {
+    const uint32_t* index = m_mod_roots.find_owner(path);
+    return (index && *index < mod_store.mod_count()) ? *index : ModStore::NONE;
+}
+
+uint32_t ModManager::find_option_owner(const fs::path& path) const {
+    const uint32_t* index = m_option_paths.find(path);
+    return (index && *index < mod_store.option_count()) ? *index : ModStore::NONE;
+}
+
+std::vector<uint32_t> ModManager::mods_under(const fs::path& root) const {
+    std::vector<uint32_t> mods;
+    m_mod_roots.for_each_under(root, [&](const fs::path&, uint32_t index) {
+        if (index < mod_store.mod_count()) mods.push_back(index);
+    });
+    return mods;
+}
+
 void ModManager::update_active_lists() {
     // --- PART 1: DATA PATHS ---
     // This is the same as before: update active_data_paths based on UI checkboxes.
-    std::set<fs::path> enabled_data_paths;
-    for (const auto& mod : mod_definitions) {
-        if (!mod.enabled) continue;
-        for (const auto& group : mod.option_groups) {
-            for (const auto& option : group.options) {
-                if (option.enabled) {
-                    enabled_data_paths.insert(option.path);
-                }
+    // Paths are compared by interned ID.
+    std::unordered_set<StringId> enabled_data_paths;
+    std::vector<StringId> enabled_in_order;
+    for (uint32_t m = 0; m < mod_store.mod_count(); ++m) {
+        if (!mod_store.mod_enabled(m)) continue;
+        for (uint32_t o = mod_store.mod_options_begin(m); o < mod_store.mod_options_end(m); ++o) {
+            if (mod_store.option_enabled(o) && enabled_data_paths.insert(mod_store.option_path_id(o)).second) {
+                enabled_in_order.push_back(mod_store.option_path_id(o));
             }
         }
     }
 
     std::vector<fs::path> new_active_data_paths;
-    std::set<fs::path> paths_in_new_list;
+    std::unordered_set<StringId> paths_in_new_list;
     for (const auto& path : active_data_paths) {
-        if (enabled_data_paths.count(path)) {
+        StringId id = intern(path.string());
+        if (enabled_data_paths.count(id)) {
             new_active_data_paths.push_back(path);
-            paths_in_new_list.insert(path);
+            paths_in_new_list.insert(id);
         }
     }
-    for (const auto& path : enabled_data_paths) {
-        if (paths_in_new_list.find(path) == paths_in_new_list.end()) {
-            new_active_data_paths.push_back(path);
-        }
+    std::vector<StringId> added_paths;
+    for (StringId id : enabled_in_order) {
+        if (!paths_in_new_list.count(id)) added_paths.push_back(id);
     }
+    // Newly enabled paths go to the end, in path order.
+    std::sort(added_paths.begin(), added_paths.end(),
+              [](StringId a, StringId b) { return fs::path(interned(a)) < fs::path(interned(b)); });
+    for (StringId id : added_paths) new_active_data_paths.push_back(interned(id));
     active_data_paths = new_active_data_paths;
 
     // --- PART 2: CONTENT FILES (NEW, SIMPLER LOGIC) ---
     
     // A. Discover all plugins available in the *new* set of active data paths.
-    std::map<std::string, std::string> available_plugins; // map<plugin_name, source_mod>
+    // The plugin index already knows every path's plugins and owning mod, so
+    // nothing is listed here. A later data path wins the plugin's source mod,
+    // as in the VFS.
+    plugin_index.set_active_paths(active_data_paths);
+    const StringId unknown = intern("Unknown");
+    std::unordered_map<StringId, StringId> available_plugins; // plugin -> source mod
     for (const auto& p : active_data_paths) {
-        // Find which mod definition this data path belongs to
-        std::string source_mod_name = "Unknown";
-        bool found = false;
-        for (const auto& mod : mod_definitions) {
-            for (const auto& group : mod.option_groups) {
-                for (const auto& option : group.options) {
-                    if (option.path == p) {
-                        source_mod_name = mod.name;
-                        found = true; break;
-                    }
-                }
-                if (found) break;
-            }
-            if (found) break;
-        }
-        for (const auto& plugin_name : find_plugins_in_path(p)) {
-            available_plugins[plugin_name] = source_mod_name;
+        StringId path = intern(p.string());
+        StringId source_mod = plugin_index.owner_mod(path);
+        if (source_mod == StringPool::EMPTY) source_mod = unknown;
+        for (StringId plugin : plugin_index.plugins_in(path)) {
+            available_plugins[plugin] = source_mod;
         }
     }
 
     // B. Rebuild the active_content_files list.
     std::vector<ContentFile> new_active_content_files;
-    std::set<std::string> plugins_in_new_list;
+    std::unordered_set<StringId> plugins_in_new_list;
 
     // First pass: Preserve the order and state of existing files that are still available.
     for (const auto& existing_cf : active_content_files) {
@@ -249,17 +376,130 @@ void ModManager::update_active_lists() {
         }
     }
 
-    // Second pass: Add any brand new, discovered plugins to the end as disabled.
+    // Second pass: Add any brand new, discovered plugins to the end as disabled,
+    // sorted by name.
+    std::vector<std::pair<StringId, StringId>> discovered;
     for (const auto& pair : available_plugins) {
-        if (plugins_in_new_list.find(pair.first) == plugins_in_new_list.end()) {
-            ContentFile new_file;
-            new_file.name = pair.first;
-            new_file.enabled = false;   // Set to DISABLED by default.
-            new_file.source_mod = pair.second;
-            new_file.is_new = true;     // Flag it as NEW for the UI.
-            new_active_content_files.push_back(new_file);
-        }
+        if (!plugins_in_new_list.count(pair.first)) discovered.push_back(pair);
+    }
+    std::sort(discovered.begin(), discovered.end(),
+              [](const std::pair<StringId, StringId>& a, const std::pair<StringId, StringId>& b) {
+                  return interned(a.first) < interned(b.first);
+              });
+    for (const auto& pair : discovered) {
+        ContentFile new_file;
+        new_file.name = pair.first;
+        new_file.enabled = false;   // Set to DISABLED by default.
+        new_file.source_mod = pair.second;
+        new_file.is_new = true;     // Flag it as NEW for the UI.
+        new_active_content_files.push_back(new_file);
     }
     
     active_content_files = new_active_content_files;
+    m_lists_consistent = true;
+}
+
+// =============================================================================
+// INCREMENTAL TOGGLES
+// =============================================================================
+
+void ModManager::stage_option(ListDelta& delta, uint32_t option, bool active) const {
+    StringId path = mod_store.option_path_id(option);
+    if (plugin_index.is_active(path) == active) return;
+    (active ? delta.enable_paths : delta.disable_paths).push_back(path);
+}
+
+void ModManager::apply_option_toggle(uint32_t option, bool enabled) {
+    uint32_t group = mod_store.option_group(option);
+    bool mod_enabled = mod_store.mod_enabled(mod_store.group_mod(group));
+    ListDelta delta;
+
+    mod_store.set_option_enabled(option, enabled);
+    if (enabled && mod_store.group_single_choice(group)) {
+        for (uint32_t other = mod_store.group_options_begin(group); other < mod_store.group_options_end(group); ++other) {
+            if (other == option || !mod_store.option_enabled(other)) continue;
+            mod_store.set_option_enabled(other, false);
+            if (mod_enabled) stage_option(delta, other, false);
+        }
+    }
+    if (mod_enabled) stage_option(delta, option, enabled);
+
+    if (!m_lists_consistent) update_active_lists();
+    else apply_delta(delta);
+}
+
+void ModManager::apply_mod_toggle(uint32_t mod, bool enabled) {
+    mod_store.set_mod_enabled(mod, enabled);
+    if (enabled) {
+        for (uint32_t group = mod_store.mod_groups_begin(mod); group < mod_store.mod_groups_end(mod); ++group) {
+            uint32_t first = mod_store.group_options_begin(group);
+            if (mod_store.group_required(group) && first < mod_store.group_options_end(group)) {
+                mod_store.set_option_enabled(first, true);
+            }
+        }
+    }
+
+    ListDelta delta;
+    for (uint32_t o = mod_store.mod_options_begin(mod); o < mod_store.mod_options_end(mod); ++o) {
+        if (mod_store.option_enabled(o)) stage_option(delta, o, enabled);
+    }
+
+    if (!m_lists_consistent) update_active_lists();
+    else apply_delta(delta);
+}
+
+void ModManager::apply_delta(ListDelta& delta) {
+    if (delta.enable_paths.empty() && delta.disable_paths.empty()) return;
+    const StringId unknown = intern("Unknown");
+
+    // Plugins the enabled paths bring in that were unavailable before, with
+    // the mod of the last such path as their source. Anything available
+    // before is already in the content list.
+    std::sort(delta.enable_paths.begin(), delta.enable_paths.end(),
+              [](StringId a, StringId b) { return fs::path(interned(a)) < fs::path(interned(b)); });
+    std::vector<ContentFile> discovered;
+    IdMap discovered_slots; // plugin -> index in discovered
+    for (StringId path : delta.enable_paths) {
+        StringId owner = plugin_index.owner_mod(path);
+        for (StringId plugin : plugin_index.plugins_in(path)) {
+            if (plugin_index.is_available(plugin)) continue;
+            uint32_t slot = discovered_slots.find(plugin);
+            if (slot == IdMap::NONE) {
+                slot = static_cast<uint32_t>(discovered.size());
+                discovered_slots.insert(plugin, slot);
+                discovered.emplace_back();
+            }
+            discovered[slot] = ContentFile{plugin, false, owner != StringPool::EMPTY ? owner : unknown, true};
+        }
+    }
+
+    for (StringId path : delta.disable_paths) plugin_index.set_path_active(path, false);
+    for (StringId path : delta.enable_paths) plugin_index.set_path_active(path, true);
+
+    // Disabled paths leave the list, along with any plugin nothing active provides any more.
+    if (!delta.disable_paths.empty()) {
+        IdMap gone_paths, gone_plugins;
+        for (StringId path : delta.disable_paths) {
+            gone_paths.insert(path, 1);
+            for (StringId plugin : plugin_index.plugins_in(path)) {
+                if (!plugin_index.is_available(plugin)) gone_plugins.insert(plugin, 1);
+            }
+        }
+        active_data_paths.erase(std::remove_if(active_data_paths.begin(), active_data_paths.end(),
+            [&](const fs::path& p) {
+                StringId id;
+                return string_pool().find(p.string(), id) && gone_paths.find(id) != IdMap::NONE;
+            }), active_data_paths.end());
+        if (gone_plugins.size()) {
+            active_content_files.erase(std::remove_if(active_content_files.begin(), active_content_files.end(),
+                [&](const ContentFile& cf) { return gone_plugins.find(cf.name) != IdMap::NONE; }),
+                active_content_files.end());
+        }
+    }
+
+    // New paths go to the end in path order, new plugins after them by name.
+    for (StringId path : delta.enable_paths) active_data_paths.push_back(interned(path));
+    std::sort(discovered.begin(), discovered.end(),
+              [](const ContentFile& a, const ContentFile& b) { return interned(a.name) < interned(b.name); });
+    active_content_files.insert(active_content_files.end(), discovered.begin(), discovered.end());
 }
@@ -3,13 +3,54 @@
 #include <vector>
 #include <map>
 #include <boost/filesystem.hpp>
+#include "../utils/PathTrie.h"
+#include "../utils/Progress.h"
+#include "ModStore.h"
+#include "PluginIndex.h"
 
 namespace fs = boost::filesystem;
 
-std::vector<std::string> find_plugins_in_path(const fs::path& path);
+class WorkerPool;
+class DirectorySource;
+struct ListedDir;
+
+// Both read the real filesystem unless given another DirectorySource.
+std::vector<std::string> find_plugins_in_path(const fs::path& path, DirectorySource* source = nullptr);
+bool is_plugin_name(const std::string& filename);
 
 // Forward declare to resolve circular dependency
 struct ModOptionGroup;
+struct ModDefinition;
+
+// Bounds on how much of a mod the optional-folder search may walk.
+struct ModScanLimits {
+    int max_depth = 12;             // directory levels below the mod root
+    uint64_t max_entries = 200000;  // directory entries read for one mod
+    CancelToken cancel;             // once cancelled, the search stops as if truncated
+};
+
+// What scanning one mod cost.
+struct ModScanStats {
+    fs::path root;
+    uint64_t dirs_read = 0;
+    uint64_t entries_read = 0;
+    uint64_t stats = 0;         // stat() calls issued on the scanning thread
+    double wall_ms = 0.0;
+    bool cached = false;        // served from the scan index, nothing was read
+    bool truncated = false;     // a depth or entry budget cut the search short
+    uint32_t cycles = 0;        // directories skipped because they were already visited
+};
+
+// Parses a single mod directory. If `listed_dirs` is given, it is set to every
+// directory whose listing influenced the result, each with the stamp it had
+// when it was read (used by the scan index).
+// With a `source`, the layout rules run on that tree instead of the disk.
+ModDefinition parse_mod_directory(const fs::path& mod_root_path, std::vector<ListedDir>* listed_dirs = nullptr,
+                                  DirectorySource* source = nullptr, const ModScanLimits* limits = nullptr,
+                                  ModScanStats* stats = nullptr);
+
+// The parser's output format. Plain values, safe to copy; ModManager keeps
+// mods in a flat ModStore instead.
 
 // Represents a single configurable choice within a mod
 struct ModOption {
@@ -17,7 +58,6 @@ struct ModOption {
     fs::path path;
     std::vector<std::string> discovered_plugins; // An option can enable multiple plugins
     bool enabled = false;
-    ModOptionGroup* parent_group = nullptr; // Pointer back to the parent group
 };
 
 // A group of options, often mutually exclusive
@@ -34,7 +74,6 @@ struct ModDefinition {
     std::string name;
     fs::path root_path;
     std::vector<ModOptionGroup> option_groups;
-    std::vector<ModOption> standalone_plugins;
     bool enabled = false;
 };
 
@@ -43,27 +82,74 @@ struct ModDisplayItem {
     enum ItemType { MOD, GROUP, OPTION, PLUGIN };
     ItemType type;
     int indent = 0;
-    void* ptr = nullptr; // A void* pointer back to the original ModDefinition, ModOptionGroup, etc.
+    uint32_t index = ModStore::NONE; // Into the ModStore array matching `type`
 };
 
 // --- NEW STRUCT for managing content files ---
 struct ContentFile {
-    std::string name;
+    StringId name = StringPool::EMPTY;       // Interned plugin file name
     bool enabled = true;
-    std::string source_mod; // Helpful for display
+    StringId source_mod = StringPool::EMPTY; // Interned mod name, helpful for display
     bool is_new = false;    // To flag newly discovered plugins in the UI
 };
 
 // The main class that holds all state and logic
 class ModManager {
 public:
-    void scan_mods(const fs::path& mod_data_path);
+    // Parses every mod directory in `mod_data_path`, in parallel if a pool is given.
+    void scan_mods(const fs::path& mod_data_path, WorkerPool* pool = nullptr);
     void sync_ui_state_from_active_lists();
+    void sync_ui_state_for(uint32_t mod);
+    // Rebuilds both active lists from every mod's checkbox state.
     void update_active_lists();
 
-    std::vector<ModDefinition> mod_definitions;
+    // Checkbox handlers that update the store and patch the active lists
+    // for just the data paths involved, at a cost proportional to their
+    // plugins rather than the whole load order. Same ordering rules as
+    // update_active_lists(): surviving entries keep their place, new data
+    // paths and plugins are appended (plugins disabled, flagged new).
+    // Turning on a single-choice option turns its siblings off.
+    void apply_option_toggle(uint32_t option, bool enabled);
+    void apply_mod_toggle(uint32_t mod, bool enabled);
+    // Call after editing active_data_paths or active_content_files by hand;
+    // the next toggle then does a full update_active_lists().
+    void invalidate_active_lists() { m_lists_consistent = false; }
+
+    // Replaces every mod (in order), rebuilds the path index and brings
+    // plugin_index up to date.
+    void set_mods(const std::vector<ModDefinition>& mods);
+
+    // Path index over mod_store. Rebuilt by set_mods().
+    void rebuild_path_index();
+    // The mod whose root is `path` or its nearest indexed ancestor, or ModStore::NONE.
+    uint32_t find_mod_owning(const fs::path& path) const;
+    // The option whose path is exactly `path`, or ModStore::NONE.
+    uint32_t find_option_owner(const fs::path& path) const;
+    // Every mod rooted at or below `root`.
+    std::vector<uint32_t> mods_under(const fs::path& root) const;
+
+    ModStore mod_store;
+    // Plugin -> providing data paths and mods. Follows mod_store through
+    // set_mods() and the active data paths through update_active_lists();
+    // code that edits active_data_paths directly calls set_active_paths().
+    PluginIndex plugin_index;
 
     // The final, reorderable lists for the config file
     std::vector<fs::path> active_data_paths;
     std::vector<ContentFile> active_content_files; // CHANGED to the new struct
+
+private:
+    // Pending edits from one toggle, applied together.
+    struct ListDelta {
+        std::vector<StringId> enable_paths;
+        std::vector<StringId> disable_paths;
+    };
+    void stage_option(ListDelta& delta, uint32_t option, bool active) const;
+    void apply_delta(ListDelta& delta);
+
+    PathTrie<uint32_t> m_mod_roots;
+    PathTrie<uint32_t> m_option_paths;
+    // True while the active lists are exactly what update_active_lists()
+    // would produce, which the delta toggles rely on.
+    bool m_lists_consistent = false;
 };
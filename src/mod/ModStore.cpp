@@ -0,0 +1,137 @@
+#include "ModStore.h"
+#include "ModManager.h"
+
+void ModStore::clear() {
+    m_chars.clear();
+    m_mod_name.clear(); m_mod_root.clear(); m_mod_first_group.clear(); m_mod_enabled.clear();
+    m_group_name.clear(); m_group_mod.clear(); m_group_first_option.clear();
+    m_group_single_choice.clear(); m_group_required.clear();
+    m_option_name.clear(); m_option_path.clear(); m_option_group.clear();
+    m_option_first_plugin.clear(); m_option_enabled.clear();
+    m_plugin_name.clear();
+}
+
+uint32_t ModStore::store_string(const std::string& s) {
+    uint32_t offset = static_cast<uint32_t>(m_chars.size());
+    m_chars.append(s);
+    m_chars.push_back('\0');
+    return offset;
+}
+
+void ModStore::assign(const std::vector<ModDefinition>& mods) {
+    clear();
+    // Size everything up front: one allocation per array instead of many.
+    size_t groups = 0, options = 0, plugins = 0, chars = 0;
+    for (const auto& mod : mods) {
+        groups += mod.option_groups.size();
+        for (const auto& group : mod.option_groups) {
+            chars += group.name.size() + 1;
+            options += group.options.size();
+            for (const auto& option : group.options) {
+                chars += option.name.size() + 1;
+                plugins += option.discovered_plugins.size();
+            }
+        }
+    }
+    m_chars.reserve(chars);
+    m_mod_name.reserve(mods.size()); m_mod_root.reserve(mods.size());
+    m_mod_first_group.reserve(mods.size()); m_mod_enabled.reserve(mods.size());
+    m_group_name.reserve(groups); m_group_mod.reserve(groups); m_group_first_option.reserve(groups);
+    m_group_single_choice.reserve(groups); m_group_required.reserve(groups);
+    m_option_name.reserve(options); m_option_path.reserve(options); m_option_group.reserve(options);
+    m_option_first_plugin.reserve(options); m_option_enabled.reserve(options);
+    m_plugin_name.reserve(plugins);
+
+    for (const auto& mod : mods) add(mod);
+}
+
+uint32_t ModStore::add(const ModDefinition& mod) {
+    uint32_t m = mod_count();
+    m_mod_name.push_back(intern(mod.name));
+    m_mod_root.push_back(intern(mod.root_path.string()));
+    m_mod_first_group.push_back(group_count());
+    m_mod_enabled.push_back(mod.enabled ? 1 : 0);
+
+    for (const auto& group : mod.option_groups) {
+        uint32_t g = group_count();
+        m_group_name.push_back(store_string(group.name));
+        m_group_mod.push_back(m);
+        m_group_first_option.push_back(option_count());
+        m_group_single_choice.push_back(group.type == ModOptionGroup::SINGLE_CHOICE ? 1 : 0);
+        m_group_required.push_back(group.required ? 1 : 0);
+
+        for (const auto& option : group.options) {
+            m_option_name.push_back(store_string(option.name));
+            m_option_path.push_back(intern(option.path.string()));
+            m_option_group.push_back(g);
+            m_option_first_plugin.push_back(plugin_count());
+            m_option_enabled.push_back(option.enabled ? 1 : 0);
+            for (const auto& plugin : option.discovered_plugins) {
+                m_plugin_name.push_back(intern(plugin));
+            }
+        }
+    }
+    return m;
+}
+
+ModDefinition ModStore::to_definition(uint32_t m) const {
+    ModDefinition mod;
+    mod.name = mod_name(m);
+    mod.root_path = mod_root(m);
+    mod.enabled = mod_enabled(m);
+    for (uint32_t g = mod_groups_begin(m); g < mod_groups_end(m); ++g) {
+        ModOptionGroup group;
+        group.name = group_name(g);
+        group.type = group_single_choice(g) ? ModOptionGroup::SINGLE_CHOICE : ModOptionGroup::MULTIPLE_CHOICE;
+        group.required = group_required(g);
+        for (uint32_t o = group_options_begin(g); o < group_options_end(g); ++o) {
+            ModOption option;
+            option.name = option_name(o);
+            option.path = option_path(o);
+            option.enabled = option_enabled(o);
+            for (uint32_t p = option_plugins_begin(o); p < option_plugins_end(o); ++p) {
+                option.discovered_plugins.emplace_back(plugin_name(p));
+            }
+            group.options.push_back(std::move(option));
+        }
+        mod.option_groups.push_back(std::move(group));
+    }
+    return mod;
+}
+
+std::vector<ModDefinition> ModStore::to_definitions() const {
+    std::vector<ModDefinition> mods;
+    mods.reserve(mod_count());
+    for (uint32_t m = 0; m < mod_count(); ++m) mods.push_back(to_definition(m));
+    return mods;
+}
+
+uint32_t ModStore::find_mod(const fs::path& root_path) const {
+    StringId root;
+    if (!string_pool().find(root_path.string(), root)) return NONE;
+    for (uint32_t m = 0; m < mod_count(); ++m) {
+        if (m_mod_root[m] == root) return m;
+    }
+    return NONE;
+}
+
+uint32_t ModStore::mod_options_begin(uint32_t m) const {
+    uint32_t g = mod_groups_begin(m);
+    return g < mod_groups_end(m) ? group_options_begin(g) : 0;
+}
+
+uint32_t ModStore::mod_options_end(uint32_t m) const {
+    uint32_t g = mod_groups_end(m);
+    return g > mod_groups_begin(m) ? group_options_end(g - 1) : 0;
+}
+
+size_t ModStore::memory_bytes() const {
+    return m_chars.capacity() +
+           (m_mod_name.capacity() + m_mod_root.capacity() + m_mod_first_group.capacity()) * sizeof(uint32_t) +
+           m_mod_enabled.capacity() +
+           (m_group_name.capacity() + m_group_mod.capacity() + m_group_first_option.capacity()) * sizeof(uint32_t) +
+           m_group_single_choice.capacity() + m_group_required.capacity() +
+           (m_option_name.capacity() + m_option_path.capacity() + m_option_group.capacity() +
+            m_option_first_plugin.capacity()) * sizeof(uint32_t) +
+           m_option_enabled.capacity() + m_plugin_name.capacity() * sizeof(uint32_t);
+}
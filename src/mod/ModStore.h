@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include "../utils/StringPool.h"
+
+namespace fs = boost::filesystem;
+
+struct ModDefinition;
+
+// Flat storage for every discovered mod. Mods, groups, options and plugin
+// names each live in their own set of parallel arrays and refer to one
+// another by 32-bit index. A mod's groups, a group's options and an option's
+// plugins are contiguous ranges, so walking the tree is a few linear scans.
+// Mod names, roots, option paths and plugin names are StringPool IDs, shared
+// with the active lists; group and option names are NUL-terminated slices of
+// the store's own character arena.
+//
+// Indices stay valid until the store is rebuilt (assign/clear); string
+// pointers until the next call that adds to it.
+class ModStore {
+public:
+    static const uint32_t NONE = 0xFFFFFFFFu;
+
+    void clear();
+    // Replaces the contents with `mods`, in order.
+    void assign(const std::vector<ModDefinition>& mods);
+    uint32_t add(const ModDefinition& mod);
+
+    // Back to the parser's nested format (for caching and incremental edits).
+    ModDefinition to_definition(uint32_t mod) const;
+    std::vector<ModDefinition> to_definitions() const;
+
+    // Index of the mod whose root is exactly `root_path`, or NONE.
+    uint32_t find_mod(const fs::path& root_path) const;
+
+    // --- Mods ---
+    uint32_t mod_count() const { return static_cast<uint32_t>(m_mod_name.size()); }
+    StringId mod_name_id(uint32_t m) const { return m_mod_name[m]; }
+    StringId mod_root_id(uint32_t m) const { return m_mod_root[m]; }
+    const char* mod_name(uint32_t m) const { return string_pool().c_str(m_mod_name[m]); }
+    const char* mod_root(uint32_t m) const { return string_pool().c_str(m_mod_root[m]); }
+    bool mod_enabled(uint32_t m) const { return m_mod_enabled[m] != 0; }
+    void set_mod_enabled(uint32_t m, bool enabled) { m_mod_enabled[m] = enabled ? 1 : 0; }
+    uint32_t mod_groups_begin(uint32_t m) const { return m_mod_first_group[m]; }
+    uint32_t mod_groups_end(uint32_t m) const { return m + 1 < mod_count() ? m_mod_first_group[m + 1] : group_count(); }
+    uint32_t mod_options_begin(uint32_t m) const;
+    uint32_t mod_options_end(uint32_t m) const;
+
+    // --- Groups ---
+    uint32_t group_count() const { return static_cast<uint32_t>(m_group_name.size()); }
+    const char* group_name(uint32_t g) const { return str(m_group_name[g]); }
+    bool group_single_choice(uint32_t g) const { return m_group_single_choice[g] != 0; }
+    bool group_required(uint32_t g) const { return m_group_required[g] != 0; }
+    uint32_t group_mod(uint32_t g) const { return m_group_mod[g]; }
+    uint32_t group_options_begin(uint32_t g) const { return m_group_first_option[g]; }
+    uint32_t group_options_end(uint32_t g) const { return g + 1 < group_count() ? m_group_first_option[g + 1] : option_count(); }
+
+    // --- Options ---
+    uint32_t option_count() const { return static_cast<uint32_t>(m_option_name.size()); }
+    const char* option_name(uint32_t o) const { return str(m_option_name[o]); }
+    StringId option_path_id(uint32_t o) const { return m_option_path[o]; }
+    const char* option_path(uint32_t o) const { return string_pool().c_str(m_option_path[o]); }
+    bool option_enabled(uint32_t o) const { return m_option_enabled[o] != 0; }
+    void set_option_enabled(uint32_t o, bool enabled) { m_option_enabled[o] = enabled ? 1 : 0; }
+    uint32_t option_group(uint32_t o) const { return m_option_group[o]; }
+    uint32_t option_mod(uint32_t o) const { return m_group_mod[m_option_group[o]]; }
+    uint32_t option_plugins_begin(uint32_t o) const { return m_option_first_plugin[o]; }
+    uint32_t option_plugins_end(uint32_t o) const { return o + 1 < option_count() ? m_option_first_plugin[o + 1] : plugin_count(); }
+
+    // --- Plugins ---
+    uint32_t plugin_count() const { return static_cast<uint32_t>(m_plugin_name.size()); }
+    StringId plugin_id(uint32_t p) const { return m_plugin_name[p]; }
+    const char* plugin_name(uint32_t p) const { return string_pool().c_str(m_plugin_name[p]); }
+
+    // Approximate heap use, for diagnostics.
+    size_t memory_bytes() const;
+
+private:
+    uint32_t store_string(const std::string& s);
+    const char* str(uint32_t offset) const { return m_chars.data() + offset; }
+
+    std::string m_chars; // arena: every string followed by a NUL
+
+    // Mods
+    std::vector<StringId> m_mod_name;
+    std::vector<StringId> m_mod_root;
+    std::vector<uint32_t> m_mod_first_group;
+    std::vector<uint8_t> m_mod_enabled;
+
+    // Groups
+    std::vector<uint32_t> m_group_name;
+    std::vector<uint32_t> m_group_mod;
+    std::vector<uint32_t> m_group_first_option;
+    std::vector<uint8_t> m_group_single_choice;
+    std::vector<uint8_t> m_group_required;
+
+    // Options
+    std::vector<uint32_t> m_option_name;
+    std::vector<StringId> m_option_path;
+    std::vector<uint32_t> m_option_group;
+    std::vector<uint32_t> m_option_first_plugin;
+    std::vector<uint8_t> m_option_enabled;
+
+    // Plugins
+    std::vector<StringId> m_plugin_name;
+};
@@ -0,0 +1,202 @@
+#include "PluginCleaner.h"
+#include "DirtyCheck.h"
+#include "PluginRecords.h"
+#include "../utils/DirListing.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t RECORD_HEADER_SIZE = 16;
+const size_t SUBRECORD_HEADER_SIZE = 8;
+const size_t HEDR_RECORDS_OFFSET = 296; // version, type, author[32], description[256], records
+const char* MANIFEST_NAME = "esmm_cleaned.txt";
+
+#ifdef IOV_MAX
+const size_t MAX_IOV = IOV_MAX;
+#else
+const size_t MAX_IOV = 1024;
+#endif
+
+uint32_t read_u32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Lowers the record count in the HEDR of a copied TES3 header record.
+void patch_record_count(std::string& header, size_t removed) {
+    size_t p = RECORD_HEADER_SIZE;
+    while (header.size() - p >= SUBRECORD_HEADER_SIZE) {
+        size_t len = read_u32(&header[p + 4]);
+        p += SUBRECORD_HEADER_SIZE;
+        if (len > header.size() - p) return;
+        if (std::memcmp(&header[p - SUBRECORD_HEADER_SIZE], "HEDR", 4) == 0 && len >= HEDR_RECORDS_OFFSET + 4) {
+            uint32_t count = read_u32(&header[p + HEDR_RECORDS_OFFSET]);
+            count = count > removed ? static_cast<uint32_t>(count - removed) : 0;
+            std::memcpy(&header[p + HEDR_RECORDS_OFFSET], &count, sizeof(count));
+            return;
+        }
+        p += len;
+    }
+}
+
+// writev() every span, in IOV_MAX batches, picking up after short writes.
+bool write_all(int fd, std::vector<iovec>& spans, const CancelToken& cancel, ProgressSink* progress) {
+    size_t next = 0;
+    while (next < spans.size()) {
+        if (cancel.is_cancelled()) return false;
+        int batch = static_cast<int>(std::min(MAX_IOV, spans.size() - next));
+        ssize_t written = ::writev(fd, &spans[next], batch);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (progress) progress->advance(static_cast<uint64_t>(written));
+        size_t left = static_cast<size_t>(written);
+        while (next < spans.size() && left >= spans[next].iov_len) left -= spans[next++].iov_len;
+        if (left) {
+            spans[next].iov_base = static_cast<char*>(spans[next].iov_base) + left;
+            spans[next].iov_len -= left;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool clean_plugin(const fs::path& source, const PluginDirtyReport& report, const fs::path& dest,
+                  CleanResult& result, const CancelToken& cancel, ProgressSink* progress) {
+    auto start = std::chrono::steady_clock::now();
+    result = CleanResult();
+
+    int in = open_path_readonly(source);
+    struct stat st;
+    if (in < 0 || ::fstat(in, &st) != 0 || st.st_size < static_cast<off_t>(RECORD_HEADER_SIZE)) {
+        if (in >= 0) ::close(in);
+        result.error = "cannot read " + source.string();
+        return false;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    result.source_stamp = file_stamp_of(st);
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, in, 0);
+    ::close(in);
+    if (map == MAP_FAILED) {
+        result.error = "cannot map " + source.string();
+        return false;
+    }
+    ::madvise(map, size, MADV_SEQUENTIAL);
+    const char* data = static_cast<const char*>(map);
+    result.bytes_in = size;
+
+    // 1. Locate the records again, and make sure they are the ones checked.
+    PluginRecords records;
+    std::vector<size_t> offsets;
+    if (!parse_plugin_records(data, size, records, cancel, nullptr, &offsets) || records.digest != report.digest) {
+        ::munmap(map, size);
+        result.error = cancel.is_cancelled() ? "cancelled" : source.filename().string() + " changed since it was checked";
+        return false;
+    }
+    std::vector<char> drop(records.records.size(), 0);
+    for (const auto& edit : report.edits) {
+        if (edit.kind != DirtyEdit::IDENTICAL_TO_MASTER || edit.record >= drop.size() || drop[edit.record]) continue;
+        drop[edit.record] = 1;
+        result.removed++;
+    }
+
+    // 2. The output: a patched copy of the header, then every run of kept
+    // records as one span of the mapping.
+    const size_t header_end = RECORD_HEADER_SIZE + read_u32(data + 4);
+    std::string header(data, header_end);
+    patch_record_count(header, result.removed);
+    std::vector<iovec> spans;
+    spans.push_back(iovec{&header[0], header.size()});
+    size_t pos = header_end;
+    for (size_t i = 0; i < drop.size(); ++i) {
+        if (!drop[i]) continue;
+        if (offsets[i] > pos) spans.push_back(iovec{const_cast<char*>(data + pos), offsets[i] - pos});
+        pos = offsets[i] + RECORD_HEADER_SIZE + read_u32(data + offsets[i] + 4);
+    }
+    if (size > pos) spans.push_back(iovec{const_cast<char*>(data + pos), size - pos});
+    for (const auto& span : spans) result.bytes_out += span.iov_len;
+
+    // 3. Write it beside `dest` and swap it in.
+    boost::system::error_code ec;
+    fs::create_directories(dest.parent_path(), ec);
+    fs::path temp_file = dest;
+    temp_file += ".tmp";
+    int out = ::open(temp_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    bool ok = out >= 0 && write_all(out, spans, cancel, progress) && ::fsync(out) == 0;
+    if (out >= 0 && ::close(out) != 0) ok = false;
+    ::munmap(map, size);
+    if (ok) fs::rename(temp_file, dest, ec);
+    if (!ok || ec) {
+        result.error = cancel.is_cancelled() ? "cancelled" : "cannot write " + dest.string();
+        fs::remove(temp_file, ec);
+        return false;
+    }
+
+    result.clean_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+bool CleanedCopy::source_unchanged() const {
+    FileStamp current;
+    return read_file_stamp(source, current) && current == source_stamp;
+}
+
+// One copy per line: name, size, mtime, then the source path, tab-separated.
+std::vector<CleanedCopy> load_cleaned_manifest(const fs::path& dir) {
+    std::vector<CleanedCopy> copies;
+    std::ifstream in((dir / MANIFEST_NAME).string());
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        CleanedCopy copy;
+        std::string size, mtime, source;
+        if (!std::getline(fields, copy.name, '\t') || !std::getline(fields, size, '\t') ||
+            !std::getline(fields, mtime, '\t') || !std::getline(fields, source) || copy.name.empty()) {
+            continue;
+        }
+        try {
+            copy.source_stamp.size = std::stoull(size);
+            copy.source_stamp.mtime_ns = std::stoll(mtime);
+        } catch (const std::exception&) {
+            continue;
+        }
+        copy.source = source;
+        copies.push_back(std::move(copy));
+    }
+    return copies;
+}
+
+bool save_cleaned_manifest(const fs::path& dir, const std::vector<CleanedCopy>& copies) {
+    boost::system::error_code ec;
+    const fs::path manifest = dir / MANIFEST_NAME;
+    if (copies.empty()) {
+        fs::remove(manifest, ec);
+        return !ec;
+    }
+    fs::path temp_file = manifest;
+    temp_file += ".tmp";
+    {
+        std::ofstream out(temp_file.string(), std::ios::trunc);
+        for (const auto& copy : copies) {
+            out << copy.name << '\t' << copy.source_stamp.size << '\t' << copy.source_stamp.mtime_ns << '\t'
+                << copy.source.string() << '\n';
+        }
+        if (!out) return false;
+    }
+    fs::rename(temp_file, manifest, ec);
+    return !ec;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "../utils/DirListing.h"
+#include "../utils/Progress.h"
+#include <boost/filesystem.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+struct PluginDirtyReport;
+
+struct CleanResult {
+    size_t removed = 0;      // records left out
+    uint64_t bytes_in = 0;
+    uint64_t bytes_out = 0;
+    double clean_ms = 0.0;
+    FileStamp source_stamp;  // the source as it was read
+    std::string error;       // why nothing was written, if it failed
+};
+
+// Where a cleaned copy came from, and the original's size and mtime when
+// it was cleaned. Kept in a manifest beside the copies, so a copy whose
+// original has since been updated can be found and dropped.
+struct CleanedCopy {
+    std::string name; // file name of the copy
+    fs::path source;
+    FileStamp source_stamp;
+
+    // False once the original is gone or differs from when it was cleaned.
+    bool source_unchanged() const;
+};
+
+// The manifest of the cleaned copies in `dir`; empty if there is none.
+std::vector<CleanedCopy> load_cleaned_manifest(const fs::path& dir);
+// Replaces the manifest (removes it if `copies` is empty).
+bool save_cleaned_manifest(const fs::path& dir, const std::vector<CleanedCopy>& copies);
+
+// Writes a copy of `source` to `dest` without the records `report` found
+// identical to a master. Deleted records and references are kept: they are
+// edits, just usually unwanted ones, and dropping them would change the game.
+// The source is mapped read-only and the copy is gathered straight from the
+// mapping with writev(), so only the patched header is ever copied. Refuses
+// (returns false) if `source` no longer matches the report's digest. `dest`
+// is replaced atomically and `source` is never touched, so deleting `dest`
+// rolls the plugin back. Checks `cancel` and reports bytes to `progress`.
+bool clean_plugin(const fs::path& source, const PluginDirtyReport& report, const fs::path& dest,
+                  CleanResult& result, const CancelToken& cancel = CancelToken(), ProgressSink* progress = nullptr);
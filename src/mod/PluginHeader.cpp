@@ -0,0 +1,109 @@
+#include "PluginHeader.h"
+#include "../utils/DirListing.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Record header: name[4], size, unused, flags. Subrecord header: name[4], size.
+const size_t RECORD_HEADER_SIZE = 16;
+const size_t SUBRECORD_HEADER_SIZE = 8;
+const size_t HEDR_SIZE = 300; // version, type, author[32], description[256], records
+// A header this large is a corrupt file, not a plugin with thousands of masters.
+const size_t MAX_HEADER_SIZE = 4u << 20;
+
+// TES3 files are little-endian, as is every platform we ship on.
+template <typename T>
+T read_le(const char* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+// Fixed-size, NUL-padded string field.
+std::string fixed_string(const char* p, size_t max_len) {
+    return std::string(p, std::find(p, p + max_len, '\0'));
+}
+
+} // namespace
+
+bool is_tes3_plugin_name(const std::string& filename) {
+    std::string ext = fs::path(filename).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".esp" || ext == ".esm" || ext == ".omwaddon";
+}
+
+bool parse_plugin_header(const char* data, size_t size, PluginHeader& out) {
+    out = PluginHeader();
+    if (size < RECORD_HEADER_SIZE || std::memcmp(data, "TES3", 4) != 0) return false;
+    size_t record_size = read_le<uint32_t>(data + 4);
+    if (record_size > size - RECORD_HEADER_SIZE) return false;
+
+    const char* p = data + RECORD_HEADER_SIZE;
+    const char* end = p + record_size;
+    bool have_hedr = false;
+    while (static_cast<size_t>(end - p) >= SUBRECORD_HEADER_SIZE) {
+        const char* name = p;
+        size_t len = read_le<uint32_t>(p + 4);
+        p += SUBRECORD_HEADER_SIZE;
+        if (len > static_cast<size_t>(end - p)) return false;
+
+        if (std::memcmp(name, "HEDR", 4) == 0 && len >= HEDR_SIZE) {
+            out.version = read_le<float>(p);
+            out.file_type = read_le<uint32_t>(p + 4);
+            out.author = fixed_string(p + 8, 32);
+            out.description = fixed_string(p + 40, 256);
+            out.record_count = read_le<uint32_t>(p + 296);
+            have_hedr = true;
+        } else if (std::memcmp(name, "MAST", 4) == 0) {
+            PluginMaster master;
+            master.name = fixed_string(p, len);
+            out.masters.push_back(std::move(master));
+        } else if (std::memcmp(name, "DATA", 4) == 0 && len >= 8 && !out.masters.empty()) {
+            out.masters.back().size = read_le<uint64_t>(p);
+        }
+        p += len;
+    }
+
+    out.valid = have_hedr;
+    return out.valid;
+}
+
+bool read_plugin_header(const fs::path& path, PluginHeader& out) {
+    out = PluginHeader();
+    int fd = open_path_readonly(path);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(RECORD_HEADER_SIZE)) {
+        ::close(fd);
+        return false;
+    }
+    const size_t file_size = static_cast<size_t>(st.st_size);
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+
+    // Map the first page; the header record usually fits. If it doesn't, the
+    // record's own size says exactly how much more to map.
+    size_t map_size = std::min(file_size, page);
+    void* map = ::mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map != MAP_FAILED) {
+        const char* data = static_cast<const char*>(map);
+        size_t needed = RECORD_HEADER_SIZE + read_le<uint32_t>(data + 4);
+        if (std::memcmp(data, "TES3", 4) == 0 && needed > map_size && needed <= file_size &&
+            needed <= MAX_HEADER_SIZE) {
+            ::munmap(map, map_size);
+            map_size = needed;
+            map = ::mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+    }
+    ::close(fd);
+    if (map == MAP_FAILED) return false;
+
+    bool ok = parse_plugin_header(static_cast<const char*>(map), map_size, out);
+    ::munmap(map, map_size);
+    return ok;
+}
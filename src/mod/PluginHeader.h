@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+// One MAST/DATA pair from a plugin's header.
+struct PluginMaster {
+    std::string name;
+    uint64_t size = 0; // size of the master the plugin was saved against
+};
+
+// The TES3 header record of an .esp/.esm/.omwaddon: HEDR plus masters.
+struct PluginHeader {
+    enum FileType : uint32_t { ESP = 0, ESM = 1, ESS = 32 };
+
+    bool valid = false;        // false if the file is not a readable TES3 plugin
+    float version = 0.0f;      // 1.2 or 1.3
+    uint32_t file_type = ESP;
+    uint32_t record_count = 0; // records after the header
+    std::string author;
+    std::string description;
+    std::vector<PluginMaster> masters; // in load order
+
+    bool is_master() const { return file_type == ESM; }
+};
+
+// True for the plugin formats with a TES3 header (not .omwscripts).
+bool is_tes3_plugin_name(const std::string& filename);
+
+// Parses the TES3 header record at the start of `data`. Reads nothing past
+// the record, so `size` may be a prefix of the file.
+bool parse_plugin_header(const char* data, size_t size, PluginHeader& out);
+
+// Maps just the header record of `path` (normally the first page) and parses
+// it in place. Never reads the rest of the file.
+bool read_plugin_header(const fs::path& path, PluginHeader& out);
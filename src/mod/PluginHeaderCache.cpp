@@ -0,0 +1,199 @@
+#include "PluginHeaderCache.h"
+#include "../utils/CacheFile.h"
+#include "../utils/Logger.h"
+#include "../utils/WorkerPool.h"
+#include <cstring>
+#include <fstream>
+
+// Bump whenever the on-disk layout or the header parser changes.
+static const char HEADER_CACHE_MAGIC[CACHE_MAGIC_SIZE] = {'E', 'S', 'M', 'M', 'H', 'D', 'R', 'S'};
+static const uint32_t HEADER_CACHE_VERSION = 1;
+
+// =============================================================================
+// BINARY HELPERS
+// =============================================================================
+
+namespace {
+
+void write_header(CacheWriter& w, const PluginHeader& h) {
+    uint32_t version_bits;
+    std::memcpy(&version_bits, &h.version, sizeof(version_bits));
+    w.u32(h.valid ? 1 : 0);
+    w.u32(version_bits);
+    w.u32(h.file_type);
+    w.u32(h.record_count);
+    w.str(h.author);
+    w.str(h.description);
+    w.u32(static_cast<uint32_t>(h.masters.size()));
+    for (const auto& m : h.masters) {
+        w.str(m.name);
+        w.u64(m.size);
+    }
+}
+
+PluginHeader read_header(CacheReader& r) {
+    PluginHeader h;
+    h.valid = r.u32() != 0;
+    uint32_t version_bits = r.u32();
+    std::memcpy(&h.version, &version_bits, sizeof(version_bits));
+    h.file_type = r.u32();
+    h.record_count = r.u32();
+    h.author = r.str();
+    h.description = r.str();
+    uint32_t masters = r.count();
+    for (uint32_t i = 0; i < masters && r.ok(); ++i) {
+        PluginMaster m;
+        m.name = r.str();
+        m.size = r.u64();
+        h.masters.push_back(std::move(m));
+    }
+    return h;
+}
+
+} // namespace
+
+// =============================================================================
+// PLUGIN HEADER CACHE
+// =============================================================================
+
+bool PluginHeaderCache::load(const fs::path& index_file) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_dirty = false;
+
+    std::ifstream file;
+    CacheOpen opened =
+        open_cache_file(file, index_file, HEADER_CACHE_MAGIC, HEADER_CACHE_VERSION, "plugin header cache");
+    if (opened != CacheOpen::OK) {
+        m_dirty = opened == CacheOpen::INCOMPATIBLE;
+        return false;
+    }
+
+    CacheReader r{file};
+    uint32_t entries = r.count();
+    for (uint32_t i = 0; i < entries && r.ok(); ++i) {
+        std::string key = r.str();
+        Entry entry;
+        entry.stamp = r.stamp();
+        entry.header = read_header(r);
+        if (r.ok()) m_entries[key] = std::move(entry);
+    }
+
+    if (!r.ok()) {
+        LOG_WARN("Plugin header cache at ", index_file.string(), " is corrupt, rebuilding.");
+        m_entries.clear();
+        m_dirty = true;
+        return false;
+    }
+
+    LOG_DEBUG("Loaded plugin header cache with ", m_entries.size(), " entries.");
+    return true;
+}
+
+bool PluginHeaderCache::save(const fs::path& index_file) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool saved = save_cache_file(index_file, HEADER_CACHE_MAGIC, HEADER_CACHE_VERSION, "plugin header cache",
+                                 [this](CacheWriter& w) {
+        w.u32(static_cast<uint32_t>(m_entries.size()));
+        for (const auto& pair : m_entries) {
+            w.str(pair.first);
+            w.stamp(pair.second.stamp);
+            write_header(w, pair.second.header);
+        }
+    });
+    if (saved) m_dirty = false;
+    return saved;
+}
+
+bool PluginHeaderCache::get(const fs::path& path, PluginHeader& out) {
+    FileStamp stamp;
+    if (!read_file_stamp(path, stamp)) return false;
+    const std::string key = path.string();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end() && it->second.stamp == stamp) {
+            out = it->second.header;
+            return out.valid;
+        }
+    }
+
+    Entry entry;
+    entry.stamp = stamp;
+    read_plugin_header(path, entry.header);
+    out = entry.header;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries[key] = std::move(entry);
+    m_dirty = true;
+    return out.valid;
+}
+
+bool PluginHeaderCache::lookup(const fs::path& path, PluginHeader& out) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(path.string());
+    if (it == m_entries.end()) return false;
+    out = it->second.header;
+    return out.valid;
+}
+
+size_t PluginHeaderCache::index(const std::vector<fs::path>& paths, WorkerPool& pool, const CancelToken& cancel,
+                                ProgressSink* progress) {
+    // Each worker stats its plugin and, only if the stamp moved, maps the
+    // header. Results are merged under the lock afterwards.
+    struct Result {
+        bool present = false;
+        bool read = false;
+        Entry entry;
+    };
+    std::vector<Result> results(paths.size());
+    if (progress) progress->begin("Reading plugin headers", paths.size());
+
+    pool.parallel_for(paths.size(), [&](size_t i) {
+        if (cancel.is_cancelled()) return;
+        Result& result = results[i];
+        result.present = read_file_stamp(paths[i], result.entry.stamp);
+        if (result.present) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            auto it = m_entries.find(paths[i].string());
+            bool fresh = it != m_entries.end() && it->second.stamp == result.entry.stamp;
+            lock.unlock();
+            if (!fresh) {
+                read_plugin_header(paths[i], result.entry.header);
+                result.read = true;
+            }
+        }
+        if (progress) progress->advance();
+    });
+
+    size_t read = 0;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (!results[i].read) continue;
+        m_entries[paths[i].string()] = std::move(results[i].entry);
+        ++read;
+    }
+    if (read) m_dirty = true;
+    return read;
+}
+
+void PluginHeaderCache::retain_only(const std::set<std::string>& paths) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (paths.count(it->first)) {
+            ++it;
+        } else {
+            it = m_entries.erase(it);
+            m_dirty = true;
+        }
+    }
+}
+
+bool PluginHeaderCache::is_dirty() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dirty;
+}
+
+size_t PluginHeaderCache::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
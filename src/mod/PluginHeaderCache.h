@@ -0,0 +1,49 @@
+#pragma once
+#include "PluginHeader.h"
+#include "../utils/DirListing.h"
+#include "../utils/Progress.h"
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class WorkerPool;
+
+// Persistent, versioned cache of plugin headers, keyed by path. An entry is
+// reused while the file keeps the same size and mtime; anything else re-reads
+// the header. Files that turned out not to be valid plugins are remembered
+// too, so they aren't retried every launch. Thread-safe.
+class PluginHeaderCache {
+public:
+    bool load(const fs::path& index_file);
+    bool save(const fs::path& index_file);
+
+    // Up-to-date header for `path`, reading it if the cache is stale. False
+    // if the file is missing or not a valid plugin.
+    bool get(const fs::path& path, PluginHeader& out);
+    // Whatever is cached for `path`, without touching the disk.
+    bool lookup(const fs::path& path, PluginHeader& out) const;
+
+    // Brings every plugin in `paths` up to date, stat()ing and reading them
+    // in parallel. Returns how many headers had to be (re)read.
+    size_t index(const std::vector<fs::path>& paths, WorkerPool& pool, const CancelToken& cancel = CancelToken(),
+                 ProgressSink* progress = nullptr);
+
+    // Drops entries for plugins that are no longer present.
+    void retain_only(const std::set<std::string>& paths);
+
+    bool is_dirty() const;
+    size_t size() const;
+
+private:
+    struct Entry {
+        FileStamp stamp;
+        PluginHeader header;
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    bool m_dirty = false;
+};
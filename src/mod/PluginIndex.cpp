@@ -0,0 +1,235 @@
+#include "PluginIndex.h"
+#include "ModManager.h"
+
+// =============================================================================
+// PATHS AND PROVIDERS
+// =============================================================================
+
+uint32_t PluginIndex::add_path(StringId path, std::vector<StringId> plugins) {
+    uint32_t slot;
+    if (!m_free_paths.empty()) {
+        slot = m_free_paths.back();
+        m_free_paths.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(m_paths.size());
+        m_paths.emplace_back();
+        m_mark.push_back(0);
+    }
+    PathEntry& entry = m_paths[slot];
+    entry.path = path;
+    entry.mod = StringPool::EMPTY;
+    entry.option = NIL;
+    entry.plugins = std::move(plugins);
+    entry.active = false;
+    entry.live = true;
+    m_path_slots.insert(path, slot);
+    link_plugins(slot);
+    return slot;
+}
+
+void PluginIndex::release_path(uint32_t slot) {
+    activate(slot, false);
+    unlink_plugins(slot);
+    PathEntry& entry = m_paths[slot];
+    m_path_slots.erase(entry.path);
+    entry.plugins.clear();
+    entry.plugins.shrink_to_fit();
+    entry.live = false;
+    m_free_paths.push_back(slot);
+}
+
+uint32_t PluginIndex::path_slot(StringId path, bool list_if_missing) {
+    uint32_t slot = m_path_slots.find(path);
+    if (slot != IdMap::NONE || !list_if_missing) return slot;
+    // Not a mod option: list it once and keep the result.
+    std::vector<StringId> plugins;
+    for (const auto& name : find_plugins_in_path(interned(path))) plugins.push_back(intern(name));
+    return add_path(path, std::move(plugins));
+}
+
+void PluginIndex::link_plugins(uint32_t slot) {
+    const PathEntry& entry = m_paths[slot];
+    for (StringId name : entry.plugins) {
+        uint32_t p = m_plugin_slots.find(name);
+        if (p == IdMap::NONE) {
+            if (!m_free_plugins.empty()) {
+                p = m_free_plugins.back();
+                m_free_plugins.pop_back();
+            } else {
+                p = static_cast<uint32_t>(m_plugins.size());
+                m_plugins.emplace_back();
+            }
+            m_plugins[p] = PluginEntry();
+            m_plugins[p].name = name;
+            m_plugin_slots.insert(name, p);
+        }
+
+        uint32_t node;
+        if (m_free_provider != NIL) {
+            node = m_free_provider;
+            m_free_provider = m_providers[node].next;
+        } else {
+            node = static_cast<uint32_t>(m_providers.size());
+            m_providers.emplace_back();
+        }
+        m_providers[node].path = slot;
+        m_providers[node].next = m_plugins[p].first_provider;
+        m_plugins[p].first_provider = node;
+        if (entry.active) ++m_plugins[p].active_providers;
+    }
+}
+
+void PluginIndex::unlink_plugins(uint32_t slot) {
+    const PathEntry& entry = m_paths[slot];
+    for (StringId name : entry.plugins) {
+        uint32_t p = m_plugin_slots.find(name);
+        if (p == IdMap::NONE) continue;
+        uint32_t* link = &m_plugins[p].first_provider;
+        while (*link != NIL) {
+            uint32_t node = *link;
+            if (m_providers[node].path == slot) {
+                *link = m_providers[node].next;
+                m_providers[node].next = m_free_provider;
+                m_free_provider = node;
+                break;
+            }
+            link = &m_providers[node].next;
+        }
+        if (entry.active) --m_plugins[p].active_providers;
+        if (m_plugins[p].first_provider == NIL) {
+            m_plugin_slots.erase(name);
+            m_free_plugins.push_back(p);
+        }
+    }
+}
+
+void PluginIndex::activate(uint32_t slot, bool active) {
+    PathEntry& entry = m_paths[slot];
+    if (entry.active == active) return;
+    entry.active = active;
+    for (StringId name : entry.plugins) {
+        uint32_t p = m_plugin_slots.find(name);
+        if (p == IdMap::NONE) continue;
+        if (active) ++m_plugins[p].active_providers;
+        else --m_plugins[p].active_providers;
+    }
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+void PluginIndex::sync_mods(const ModStore& store) {
+    uint32_t epoch = ++m_mark_epoch;
+    std::vector<StringId> plugins;
+    for (uint32_t o = 0; o < store.option_count(); ++o) {
+        StringId path = store.option_path_id(o);
+        uint32_t slot = m_path_slots.find(path);
+        if (slot != IdMap::NONE && m_mark[slot] == epoch) continue; // first owner wins
+
+        plugins.clear();
+        for (uint32_t p = store.option_plugins_begin(o); p < store.option_plugins_end(o); ++p) {
+            plugins.push_back(store.plugin_id(p));
+        }
+        if (slot == IdMap::NONE) {
+            slot = add_path(path, plugins);
+        } else if (m_paths[slot].plugins != plugins) {
+            // Contents changed: re-link just this path.
+            bool active = m_paths[slot].active;
+            activate(slot, false);
+            unlink_plugins(slot);
+            m_paths[slot].plugins = plugins;
+            link_plugins(slot);
+            activate(slot, active);
+        }
+        m_paths[slot].mod = store.mod_name_id(store.option_mod(o));
+        m_paths[slot].option = o;
+        m_mark[slot] = epoch;
+    }
+
+    // Options that are gone. Active ones stay, as plain data paths.
+    for (uint32_t slot = 0; slot < m_paths.size(); ++slot) {
+        PathEntry& entry = m_paths[slot];
+        if (!entry.live || entry.option == NIL || m_mark[slot] == epoch) continue;
+        if (entry.active) {
+            entry.mod = StringPool::EMPTY;
+            entry.option = NIL;
+        } else {
+            release_path(slot);
+        }
+    }
+}
+
+void PluginIndex::set_active_paths(const std::vector<fs::path>& paths) {
+    uint32_t epoch = ++m_mark_epoch;
+    for (const auto& p : paths) {
+        uint32_t slot = path_slot(intern(p.string()), true);
+        m_mark[slot] = epoch;
+        activate(slot, true);
+    }
+    for (uint32_t slot = 0; slot < m_paths.size(); ++slot) {
+        if (m_paths[slot].live && m_paths[slot].active && m_mark[slot] != epoch) activate(slot, false);
+    }
+}
+
+void PluginIndex::set_path_active(StringId path, bool active) {
+    uint32_t slot = path_slot(path, active);
+    if (slot != IdMap::NONE) activate(slot, active);
+}
+
+void PluginIndex::remove_path(StringId path) {
+    uint32_t slot = m_path_slots.find(path);
+    if (slot != IdMap::NONE) release_path(slot);
+}
+
+void PluginIndex::clear() {
+    *this = PluginIndex();
+}
+
+const std::vector<StringId>& PluginIndex::plugins_in(StringId path) const {
+    static const std::vector<StringId> none;
+    uint32_t slot = m_path_slots.find(path);
+    return slot != IdMap::NONE ? m_paths[slot].plugins : none;
+}
+
+StringId PluginIndex::owner_mod(StringId path) const {
+    uint32_t slot = m_path_slots.find(path);
+    return slot != IdMap::NONE ? m_paths[slot].mod : StringPool::EMPTY;
+}
+
+uint32_t PluginIndex::owner_option(StringId path) const {
+    uint32_t slot = m_path_slots.find(path);
+    return slot != IdMap::NONE ? m_paths[slot].option : IdMap::NONE;
+}
+
+bool PluginIndex::is_active(StringId path) const {
+    uint32_t slot = m_path_slots.find(path);
+    return slot != IdMap::NONE && m_paths[slot].active;
+}
+
+bool PluginIndex::is_available(StringId plugin) const {
+    uint32_t p = m_plugin_slots.find(plugin);
+    return p != IdMap::NONE && m_plugins[p].active_providers > 0;
+}
+
+StringId PluginIndex::source_mod(StringId plugin) const {
+    uint32_t p = m_plugin_slots.find(plugin);
+    if (p == IdMap::NONE) return StringPool::EMPTY;
+    StringId any = StringPool::EMPTY;
+    for (uint32_t n = m_plugins[p].first_provider; n != NIL; n = m_providers[n].next) {
+        const PathEntry& path = m_paths[m_providers[n].path];
+        if (path.option == NIL) continue;
+        if (path.active) return path.mod;
+        if (any == StringPool::EMPTY) any = path.mod;
+    }
+    return any;
+}
+
+size_t PluginIndex::memory_bytes() const {
+    size_t bytes = m_paths.capacity() * sizeof(PathEntry) + m_free_paths.capacity() * sizeof(uint32_t) +
+                   m_plugins.capacity() * sizeof(PluginEntry) + m_free_plugins.capacity() * sizeof(uint32_t) +
+                   m_providers.capacity() * sizeof(Provider) + m_mark.capacity() * sizeof(uint32_t) +
+                   m_path_slots.memory_bytes() + m_plugin_slots.memory_bytes();
+    for (const auto& path : m_paths) bytes += path.plugins.capacity() * sizeof(StringId);
+    return bytes;
+}
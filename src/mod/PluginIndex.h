@@ -0,0 +1,107 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include "../utils/IdMap.h"
+#include "../utils/StringPool.h"
+
+namespace fs = boost::filesystem;
+
+class ModStore;
+
+// Persistent index from plugin name to every data path that provides it, and
+// from data path to its plugins and owning mod option. Kept up to date in
+// place as mods are (re)discovered, data paths are enabled or disabled and
+// mods are deleted, so nothing has to re-list directories or rebuild
+// plugin maps from scratch.
+//
+// Data paths owned by a mod option take their plugin list from the ModStore;
+// any other data path is listed once, the first time it is activated.
+// Everything is keyed by StringId through open-addressing IdMaps.
+class PluginIndex {
+public:
+    // Points mod-owned data paths at `store`'s options. Paths whose plugins
+    // are unchanged are left alone; options that vanished are dropped (or
+    // kept as plain data paths while still active). The first option wins
+    // when two share a path.
+    void sync_mods(const ModStore& store);
+
+    // Makes exactly `paths` the active data paths.
+    void set_active_paths(const std::vector<fs::path>& paths);
+    // Activates or deactivates one data path.
+    void set_path_active(StringId path, bool active);
+    // Forgets a data path entirely (e.g. its mod was deleted).
+    void remove_path(StringId path);
+    void clear();
+
+    // Plugins in `path`, in directory order; empty if the path is unknown.
+    const std::vector<StringId>& plugins_in(StringId path) const;
+    // Name of the mod whose option is `path`, or StringPool::EMPTY.
+    StringId owner_mod(StringId path) const;
+    // ModStore option index for `path`, or IdMap::NONE.
+    uint32_t owner_option(StringId path) const;
+    bool is_active(StringId path) const;
+
+    // True if some active data path provides `plugin`.
+    bool is_available(StringId plugin) const;
+    // The mod providing `plugin`, preferring active data paths, or
+    // StringPool::EMPTY if no mod option provides it.
+    StringId source_mod(StringId plugin) const;
+    // Calls fn(data_path, active) for every data path providing `plugin`.
+    template <typename Fn>
+    void for_each_provider(StringId plugin, Fn&& fn) const {
+        uint32_t p = m_plugin_slots.find(plugin);
+        if (p == IdMap::NONE) return;
+        for (uint32_t n = m_plugins[p].first_provider; n != NIL; n = m_providers[n].next) {
+            const PathEntry& path = m_paths[m_providers[n].path];
+            fn(path.path, path.active);
+        }
+    }
+
+    size_t plugin_count() const { return m_plugin_slots.size(); }
+    size_t path_count() const { return m_path_slots.size(); }
+    // Approximate heap use, for diagnostics.
+    size_t memory_bytes() const;
+
+private:
+    static const uint32_t NIL = 0xFFFFFFFFu;
+
+    struct PathEntry {
+        StringId path = StringPool::EMPTY;
+        StringId mod = StringPool::EMPTY;
+        uint32_t option = NIL;
+        std::vector<StringId> plugins;
+        bool active = false;
+        bool live = false;
+    };
+    struct PluginEntry {
+        StringId name = StringPool::EMPTY;
+        uint32_t first_provider = NIL;
+        uint32_t active_providers = 0;
+    };
+    struct Provider {
+        uint32_t path;  // slot in m_paths
+        uint32_t next;
+    };
+
+    uint32_t path_slot(StringId path, bool list_if_missing);
+    uint32_t add_path(StringId path, std::vector<StringId> plugins);
+    void release_path(uint32_t slot);
+    void link_plugins(uint32_t slot);
+    void unlink_plugins(uint32_t slot);
+    void activate(uint32_t slot, bool active);
+
+    std::vector<PathEntry> m_paths;
+    std::vector<uint32_t> m_free_paths;
+    IdMap m_path_slots;      // data path -> slot in m_paths
+
+    std::vector<PluginEntry> m_plugins;
+    std::vector<uint32_t> m_free_plugins;
+    IdMap m_plugin_slots;    // plugin name -> slot in m_plugins
+
+    std::vector<Provider> m_providers;
+    uint32_t m_free_provider = NIL; // free list threaded through Provider::next
+
+    std::vector<uint32_t> m_mark; // per path slot, scratch for the set_* diffs
+    uint32_t m_mark_epoch = 0;
+};
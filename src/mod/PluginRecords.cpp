@@ -0,0 +1,274 @@
+#include "PluginRecords.h"
+#include "../utils/DirListing.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Record header: name[4], size, unused, flags. Subrecord header: name[4], size.
+const size_t RECORD_HEADER_SIZE = 16;
+const size_t SUBRECORD_HEADER_SIZE = 8;
+// How often the walk checks for cancellation and reports progress.
+const size_t PROGRESS_STEP = 1u << 20;
+
+template <typename T>
+T read_le(const char* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+uint32_t fourcc(const char* name) { return read_le<uint32_t>(name); }
+
+const uint32_t TYPE_CELL = fourcc("CELL");
+const uint32_t TYPE_DIAL = fourcc("DIAL");
+const uint32_t TYPE_INFO = fourcc("INFO");
+const uint32_t TYPE_LAND = fourcc("LAND");
+const uint32_t TYPE_MGEF = fourcc("MGEF");
+const uint32_t TYPE_PGRD = fourcc("PGRD");
+const uint32_t TYPE_SCPT = fourcc("SCPT");
+const uint32_t TYPE_SKIL = fourcc("SKIL");
+
+std::string fixed_string(const char* p, size_t max_len) {
+    return std::string(p, std::find(p, p + max_len, '\0'));
+}
+
+std::string grid_id(int32_t x, int32_t y) {
+    return "(" + std::to_string(x) + ", " + std::to_string(y) + ")";
+}
+
+// Word-at-a-time 64-bit hash; only ever compared against itself, so it just
+// has to be fast and well mixed.
+uint64_t hash_bytes(const char* p, size_t n, uint64_t h) {
+    const uint64_t MUL = 0x9E3779B97F4A7C15ULL;
+    while (n >= 8) {
+        h ^= read_le<uint64_t>(p) * MUL;
+        h = ((h << 27) | (h >> 37)) * 0x94D049BB133111EBULL;
+        p += 8;
+        n -= 8;
+    }
+    uint64_t tail = 0;
+    if (n) std::memcpy(&tail, p, n);
+    h ^= tail * MUL + n;
+    h ^= h >> 31;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 29;
+    return h;
+}
+
+// What the game keys `type` by, from its subrecords. Empty if nothing.
+// `deleted` is set by a DELE of the record itself (not of a reference in it).
+std::string record_id(uint32_t type, const char* p, const char* end, const std::string& dialogue, bool& deleted) {
+    deleted = false;
+    std::string name;
+    std::string id;
+    bool have_id = false;
+    bool have_name = false;
+    bool have_grid = false;
+    bool interior = false;
+    int32_t x = 0, y = 0;
+    while (static_cast<size_t>(end - p) >= SUBRECORD_HEADER_SIZE) {
+        const char* sub = p;
+        size_t len = read_le<uint32_t>(p + 4);
+        p += SUBRECORD_HEADER_SIZE;
+        if (len > static_cast<size_t>(end - p)) break;
+
+        if (std::memcmp(sub, "FRMR", 4) == 0 || std::memcmp(sub, "MVRF", 4) == 0) break; // references follow
+        if (std::memcmp(sub, "DELE", 4) == 0) {
+            deleted = true;
+        } else if (!have_id) {
+            if (std::memcmp(sub, "NAME", 4) == 0 && !have_name) {
+                name = fixed_string(p, len);
+                have_name = true;
+            } else if (type == TYPE_CELL && std::memcmp(sub, "DATA", 4) == 0 && len >= 12) {
+                interior = (read_le<uint32_t>(p) & 0x1) != 0;
+                x = read_le<int32_t>(p + 4);
+                y = read_le<int32_t>(p + 8);
+                have_grid = true;
+            } else if ((type == TYPE_LAND && std::memcmp(sub, "INTV", 4) == 0 && len >= 8) ||
+                       (type == TYPE_PGRD && std::memcmp(sub, "DATA", 4) == 0 && len >= 8)) {
+                x = read_le<int32_t>(p);
+                y = read_le<int32_t>(p + 4);
+                have_grid = true;
+            } else if ((type == TYPE_SKIL || type == TYPE_MGEF) && std::memcmp(sub, "INDX", 4) == 0 && len >= 4) {
+                id = std::to_string(read_le<uint32_t>(p));
+                have_id = true;
+            } else if (type == TYPE_SCPT && std::memcmp(sub, "SCHD", 4) == 0) {
+                id = fixed_string(p, std::min<size_t>(len, 32));
+                have_id = true;
+            } else if (type == TYPE_INFO && std::memcmp(sub, "INAM", 4) == 0) {
+                id = dialogue + "/" + fixed_string(p, len);
+                have_id = true;
+            }
+        }
+        p += len;
+    }
+    if (have_id) return id;
+
+    if (type == TYPE_CELL) return have_grid && !interior ? grid_id(x, y) : name;
+    if (type == TYPE_LAND) return have_grid ? grid_id(x, y) : std::string();
+    // Interior path grids sit at (0, 0) and go by their cell's name.
+    if (type == TYPE_PGRD) return have_grid && (x != 0 || y != 0 || name.empty()) ? grid_id(x, y) : name;
+    return name;
+}
+
+// Collects the references of a CELL that carry a DELE.
+void collect_deleted_refs(uint32_t cell, const char* p, const char* end, PluginRecords& out) {
+    bool in_ref = false;
+    bool deleted = false;
+    uint32_t refnum = 0;
+    const char* object = nullptr;
+    size_t object_len = 0;
+    auto flush = [&]() {
+        if (!in_ref || !deleted) return;
+        DeletedReference ref;
+        ref.cell = cell;
+        ref.refnum = refnum;
+        std::string id = object ? fixed_string(object, object_len) : std::string();
+        ref.id_offset = static_cast<uint32_t>(out.ids.size());
+        ref.id_length = static_cast<uint32_t>(id.size());
+        out.ids += id;
+        out.deleted_refs.push_back(ref);
+    };
+    while (static_cast<size_t>(end - p) >= SUBRECORD_HEADER_SIZE) {
+        const char* sub = p;
+        size_t len = read_le<uint32_t>(p + 4);
+        p += SUBRECORD_HEADER_SIZE;
+        if (len > static_cast<size_t>(end - p)) break;
+
+        if (std::memcmp(sub, "FRMR", 4) == 0 && len >= 4) {
+            flush();
+            in_ref = true;
+            deleted = false;
+            refnum = read_le<uint32_t>(p);
+            object = nullptr;
+        } else if (in_ref && std::memcmp(sub, "NAME", 4) == 0 && !object) {
+            object = p;
+            object_len = len;
+        } else if (in_ref && std::memcmp(sub, "DELE", 4) == 0) {
+            deleted = true;
+        }
+        p += len;
+    }
+    flush();
+}
+
+inline char lower(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; }
+
+} // namespace
+
+uint64_t record_key_hash(const RecordEntry& record, const char* id) {
+    // FNV-1a over the type and the lower-cased ID...
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned i = 0; i < 4; ++i) {
+        h ^= (record.type >> (8 * i)) & 0xFF;
+        h *= 1099511628211ULL;
+    }
+    for (uint32_t i = 0; i < record.id_length; ++i) {
+        h ^= static_cast<uint8_t>(lower(id[i]));
+        h *= 1099511628211ULL;
+    }
+    // ...then a finalizer, so the high bits are as good as the low ones.
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    return h;
+}
+
+bool same_record_key(const PluginRecords& a, const RecordEntry& ra, const PluginRecords& b, const RecordEntry& rb) {
+    if (ra.type != rb.type || ra.id_length != rb.id_length) return false;
+    const char* x = a.id_data(ra);
+    const char* y = b.id_data(rb);
+    for (uint32_t i = 0; i < ra.id_length; ++i) {
+        if (lower(x[i]) != lower(y[i])) return false;
+    }
+    return true;
+}
+
+std::string record_type_name(uint32_t type) {
+    char name[4];
+    std::memcpy(name, &type, sizeof(name));
+    return std::string(name, 4);
+}
+
+bool parse_plugin_records(const char* data, size_t size, PluginRecords& out, const CancelToken& cancel,
+                          ProgressSink* progress, std::vector<size_t>* offsets) {
+    out = PluginRecords();
+    if (offsets) offsets->clear();
+    if (size < RECORD_HEADER_SIZE || std::memcmp(data, "TES3", 4) != 0) return false;
+    size_t offset = RECORD_HEADER_SIZE + read_le<uint32_t>(data + 4);
+    if (offset > size) return false;
+
+    std::string dialogue; // INFO records belong to the DIAL before them
+    size_t reported = 0;
+    while (size - offset >= RECORD_HEADER_SIZE) {
+        const char* record = data + offset;
+        size_t length = read_le<uint32_t>(record + 4);
+        if (length > size - offset - RECORD_HEADER_SIZE) return false; // truncated
+        const uint32_t type = fourcc(record);
+        const uint32_t flags = read_le<uint32_t>(record + 12);
+        const char* payload = record + RECORD_HEADER_SIZE;
+
+        bool deleted = false;
+        std::string id = record_id(type, payload, payload + length, dialogue, deleted);
+        if (type == TYPE_DIAL) dialogue = id;
+        if (id.empty()) {
+            out.unkeyed++;
+        } else {
+            if (type == TYPE_CELL) {
+                collect_deleted_refs(static_cast<uint32_t>(out.records.size()), payload, payload + length, out);
+            }
+            RecordEntry entry;
+            entry.type = type;
+            entry.flags = deleted ? (flags | RecordEntry::DELETED) : flags;
+            entry.id_offset = static_cast<uint32_t>(out.ids.size());
+            entry.id_length = static_cast<uint32_t>(id.size());
+            entry.digest = hash_bytes(payload, length, flags ^ (static_cast<uint64_t>(type) << 32));
+            out.ids += id;
+            out.records.push_back(entry);
+            if (offsets) offsets->push_back(offset);
+        }
+
+        offset += RECORD_HEADER_SIZE + length;
+        if (offset - reported >= PROGRESS_STEP) {
+            if (cancel.is_cancelled()) return false;
+            if (progress) progress->advance(offset - reported);
+            reported = offset;
+        }
+    }
+    if (progress) progress->advance(size - reported);
+
+    out.digest = hash_bytes(reinterpret_cast<const char*>(out.records.data()), out.records.size() * sizeof(RecordEntry),
+                            out.records.size());
+    out.digest = hash_bytes(reinterpret_cast<const char*>(out.deleted_refs.data()),
+                            out.deleted_refs.size() * sizeof(DeletedReference), out.digest);
+    out.digest = hash_bytes(out.ids.data(), out.ids.size(), out.digest);
+    out.valid = true;
+    return true;
+}
+
+bool read_plugin_records(const fs::path& path, PluginRecords& out, const CancelToken& cancel,
+                         ProgressSink* progress) {
+    out = PluginRecords();
+    int fd = open_path_readonly(path);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(RECORD_HEADER_SIZE)) {
+        ::close(fd);
+        return false;
+    }
+    const size_t file_size = static_cast<size_t>(st.st_size);
+    void* map = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return false;
+    ::madvise(map, file_size, MADV_SEQUENTIAL);
+
+    bool ok = parse_plugin_records(static_cast<const char*>(map), file_size, out, cancel, progress);
+    ::munmap(map, file_size);
+    return ok;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "../utils/Progress.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+// One record of a TES3 plugin, reduced to what conflict checks need.
+struct RecordEntry {
+    enum Flags : uint32_t { DELETED = 0x20, PERSISTENT = 0x400, BLOCKED = 0x2000 };
+
+    uint32_t type;      // four-character record name as a little-endian integer
+    uint32_t flags;     // record header flags
+    uint32_t id_offset; // into PluginRecords::ids
+    uint32_t id_length;
+    uint64_t digest;    // hash of the flags and every subrecord
+};
+
+// A reference inside a CELL record that the plugin marks deleted (DELE).
+struct DeletedReference {
+    uint32_t cell;      // index of the CELL in PluginRecords::records
+    uint32_t refnum;    // FRMR: object index, master index (1-based, 0 = this plugin) in the top byte
+    uint32_t id_offset; // object ID, into PluginRecords::ids
+    uint32_t id_length;
+
+    uint32_t master_index() const { return refnum >> 24; }
+};
+
+// Every identifiable record of one plugin, in file order. The TES3 header is
+// not included, and neither are records without an ID.
+struct PluginRecords {
+    bool valid = false;               // false if the file is not a readable TES3 plugin
+    std::vector<RecordEntry> records;
+    std::vector<DeletedReference> deleted_refs;
+    std::string ids;                  // record and object IDs back to back, original case
+    uint32_t unkeyed = 0;             // records skipped for having no ID
+    uint64_t digest = 0;              // hash of everything above; equal digests, equal records
+
+    std::string id(const RecordEntry& record) const { return ids.substr(record.id_offset, record.id_length); }
+    std::string id(const DeletedReference& ref) const { return ids.substr(ref.id_offset, ref.id_length); }
+    const char* id_data(const RecordEntry& record) const { return ids.data() + record.id_offset; }
+};
+
+// "NPC_", "CELL", ... for a RecordEntry::type.
+std::string record_type_name(uint32_t type);
+
+// Hash of a record's (type, case-insensitive ID), and the exact comparison
+// behind it. Two plugins define "the same record" when their keys match.
+uint64_t record_key_hash(const RecordEntry& record, const char* id);
+bool same_record_key(const PluginRecords& a, const RecordEntry& ra, const PluginRecords& b, const RecordEntry& rb);
+
+// Walks every record after the TES3 header of `data`. The ID is whatever the
+// game keys the record by: NAME for most types, the grid for exterior CELL
+// and LAND, INDX for SKIL and MGEF, the dialogue plus INAM for INFO. A DELE
+// subrecord sets RecordEntry::DELETED; inside a CELL, deleted references are
+// collected too. Checks `cancel` and reports the bytes walked to `progress`.
+// With `offsets`, also gives where each of out.records starts in `data`.
+bool parse_plugin_records(const char* data, size_t size, PluginRecords& out,
+                          const CancelToken& cancel = CancelToken(), ProgressSink* progress = nullptr,
+                          std::vector<size_t>* offsets = nullptr);
+
+// Maps the whole plugin read-only and parses it front to back. The mapping
+// is marked sequential, so the kernel reads ahead and can reclaim pages right
+// behind the walk; a several-hundred-MB plugin never has to fit in memory.
+bool read_plugin_records(const fs::path& path, PluginRecords& out,
+                         const CancelToken& cancel = CancelToken(), ProgressSink* progress = nullptr);
@@ -0,0 +1,186 @@
+#include "RecordCache.h"
+#include "../utils/CacheFile.h"
+#include "../utils/Logger.h"
+#include "../utils/WorkerPool.h"
+#include <algorithm>
+#include <fstream>
+
+// Bump whenever the on-disk layout, the record walker or the digest changes.
+static const char RECORD_CACHE_MAGIC[CACHE_MAGIC_SIZE] = {'E', 'S', 'M', 'M', 'R', 'E', 'C', 'S'};
+static const uint32_t RECORD_CACHE_VERSION = 3;
+
+static_assert(sizeof(RecordEntry) == 24, "RecordEntry is written to the cache as-is");
+static_assert(sizeof(DeletedReference) == 16, "DeletedReference is written to the cache as-is");
+
+// =============================================================================
+// BINARY HELPERS
+// =============================================================================
+
+namespace {
+
+// Generous bounds; anything past them is a corrupt file.
+const uint32_t MAX_ID_BYTES = 1u << 30;
+const uint32_t MAX_RECORDS = 1u << 26;
+
+void write_records(CacheWriter& w, const PluginRecords& r) {
+    w.u32(r.valid ? 1 : 0);
+    w.u32(r.unkeyed);
+    w.u64(r.digest);
+    w.str(r.ids);
+    w.u32(static_cast<uint32_t>(r.records.size()));
+    w.bytes(r.records.data(), r.records.size() * sizeof(RecordEntry));
+    w.u32(static_cast<uint32_t>(r.deleted_refs.size()));
+    w.bytes(r.deleted_refs.data(), r.deleted_refs.size() * sizeof(DeletedReference));
+}
+
+std::shared_ptr<PluginRecords> read_records(CacheReader& r) {
+    auto records = std::make_shared<PluginRecords>();
+    records->valid = r.u32() != 0;
+    records->unkeyed = r.u32();
+    records->digest = r.u64();
+    records->ids = r.str(MAX_ID_BYTES);
+    uint32_t n = r.count(MAX_RECORDS);
+    records->records.resize(n);
+    if (n) r.bytes(records->records.data(), n * sizeof(RecordEntry));
+    n = r.count(MAX_RECORDS);
+    records->deleted_refs.resize(n);
+    if (n) r.bytes(records->deleted_refs.data(), n * sizeof(DeletedReference));
+    for (const auto& e : records->records) {
+        if (static_cast<uint64_t>(e.id_offset) + e.id_length > records->ids.size()) r.fail();
+    }
+    for (const auto& d : records->deleted_refs) {
+        if (d.cell >= records->records.size() ||
+            static_cast<uint64_t>(d.id_offset) + d.id_length > records->ids.size()) {
+            r.fail();
+        }
+    }
+    return records;
+}
+
+} // namespace
+
+// =============================================================================
+// RECORD CACHE
+// =============================================================================
+
+bool RecordCache::load(const fs::path& index_file) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_dirty = false;
+
+    std::ifstream file;
+    CacheOpen opened = open_cache_file(file, index_file, RECORD_CACHE_MAGIC, RECORD_CACHE_VERSION, "record cache");
+    if (opened != CacheOpen::OK) {
+        m_dirty = opened == CacheOpen::INCOMPATIBLE;
+        return false;
+    }
+
+    CacheReader r{file};
+    uint32_t entries = r.count();
+    for (uint32_t i = 0; i < entries && r.ok(); ++i) {
+        std::string key = r.str();
+        Entry entry;
+        entry.stamp = r.stamp();
+        entry.records = read_records(r);
+        if (r.ok()) m_entries[key] = std::move(entry);
+    }
+
+    if (!r.ok()) {
+        LOG_WARN("Record cache at ", index_file.string(), " is corrupt, rebuilding.");
+        m_entries.clear();
+        m_dirty = true;
+        return false;
+    }
+
+    LOG_DEBUG("Loaded record cache with ", m_entries.size(), " plugins.");
+    return true;
+}
+
+bool RecordCache::save(const fs::path& index_file) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool saved = save_cache_file(index_file, RECORD_CACHE_MAGIC, RECORD_CACHE_VERSION, "record cache",
+                                 [this](CacheWriter& w) {
+        w.u32(static_cast<uint32_t>(m_entries.size()));
+        for (const auto& pair : m_entries) {
+            w.str(pair.first);
+            w.stamp(pair.second.stamp);
+            write_records(w, *pair.second.records);
+        }
+    });
+    if (saved) m_dirty = false;
+    return saved;
+}
+
+size_t RecordCache::index(const std::vector<fs::path>& paths, WorkerPool& pool, const CancelToken& cancel,
+                          ProgressSink* progress) {
+    // Stat everything first; only plugins whose stamp moved are read.
+    std::vector<Entry> stamps(paths.size());
+    std::vector<char> present(paths.size(), 0);
+    for (size_t i = 0; i < paths.size(); ++i) present[i] = read_file_stamp(paths[i], stamps[i].stamp);
+
+    std::vector<size_t> stale;
+    uint64_t stale_bytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < paths.size(); ++i) {
+            auto it = m_entries.find(paths[i].string());
+            if (!present[i]) {
+                // Gone since it was cached; never report its old records.
+                if (it != m_entries.end()) {
+                    m_entries.erase(it);
+                    m_dirty = true;
+                }
+                continue;
+            }
+            if (it != m_entries.end() && it->second.stamp == stamps[i].stamp) continue;
+            stale.push_back(i);
+            stale_bytes += stamps[i].stamp.size;
+        }
+    }
+
+    // Largest first, so one huge master doesn't start last and hold up the rest.
+    std::sort(stale.begin(), stale.end(), [&](size_t a, size_t b) { return stamps[a].stamp.size > stamps[b].stamp.size; });
+    if (progress) progress->begin("Reading plugin records", stale_bytes);
+
+    pool.parallel_for(stale.size(), [&](size_t n) {
+        if (cancel.is_cancelled()) return;
+        auto records = std::make_shared<PluginRecords>();
+        read_plugin_records(paths[stale[n]], *records, cancel, progress);
+        stamps[stale[n]].records = std::move(records);
+    });
+    if (cancel.is_cancelled()) return 0;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i : stale) m_entries[paths[i].string()] = std::move(stamps[i]);
+    if (!stale.empty()) m_dirty = true;
+    return stale.size();
+}
+
+std::shared_ptr<const PluginRecords> RecordCache::lookup(const fs::path& path) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(path.string());
+    if (it == m_entries.end() || !it->second.records->valid) return nullptr;
+    return it->second.records;
+}
+
+void RecordCache::retain_only(const std::set<std::string>& paths) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (paths.count(it->first)) {
+            ++it;
+        } else {
+            it = m_entries.erase(it);
+            m_dirty = true;
+        }
+    }
+}
+
+bool RecordCache::is_dirty() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dirty;
+}
+
+size_t RecordCache::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "PluginRecords.h"
+#include "../utils/DirListing.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class WorkerPool;
+
+// Persistent, versioned cache of per-plugin record digests, keyed by path,
+// with the same size+mtime invalidation as PluginHeaderCache. Re-checking
+// conflicts after a reorder or toggle only reads plugins that changed on
+// disk. Thread-safe.
+class RecordCache {
+public:
+    bool load(const fs::path& index_file);
+    bool save(const fs::path& index_file);
+
+    // Brings every plugin in `paths` up to date. Stale plugins are read in
+    // parallel, largest first; progress is reported in bytes. Returns how
+    // many had to be (re)read. Nothing read is kept if `cancel` fires.
+    size_t index(const std::vector<fs::path>& paths, WorkerPool& pool, const CancelToken& cancel = CancelToken(),
+                 ProgressSink* progress = nullptr);
+
+    // Cached records for `path`, without touching the disk. Null if the
+    // plugin is unknown or unreadable.
+    std::shared_ptr<const PluginRecords> lookup(const fs::path& path) const;
+
+    // Drops entries for plugins that are no longer present.
+    void retain_only(const std::set<std::string>& paths);
+
+    bool is_dirty() const;
+    size_t size() const;
+
+private:
+    struct Entry {
+        FileStamp stamp;
+        std::shared_ptr<const PluginRecords> records;
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    bool m_dirty = false;
+};
@@ -0,0 +1,198 @@
+#include "ScanIndex.h"
+#include "../utils/Logger.h"
+#include "../utils/CacheFile.h"
+#include "../utils/DirListing.h"
+#include <fstream>
+
+// Bump whenever the on-disk layout or the parser's rules change, so stale
+// indexes from older builds are discarded instead of misread.
+static const char SCAN_INDEX_MAGIC[CACHE_MAGIC_SIZE] = {'E', 'S', 'M', 'M', 'S', 'C', 'A', 'N'};
+static const uint32_t SCAN_INDEX_VERSION = 2;
+
+// =============================================================================
+// BINARY HELPERS
+// =============================================================================
+
+namespace {
+
+void write_stamp(CacheWriter& w, const DirStamp& s) {
+    w.u64(s.dev); w.u64(s.ino);
+    w.u64(static_cast<uint64_t>(s.mtime_sec)); w.u64(static_cast<uint64_t>(s.mtime_nsec));
+}
+
+void write_option(CacheWriter& w, const ModOption& o) {
+    w.str(o.name);
+    w.str(o.path.string());
+    w.u8(o.enabled ? 1 : 0);
+    w.u32(static_cast<uint32_t>(o.discovered_plugins.size()));
+    for (const auto& p : o.discovered_plugins) w.str(p);
+}
+
+void write_mod(CacheWriter& w, const ModDefinition& m) {
+    w.str(m.name);
+    w.str(m.root_path.string());
+    w.u8(m.enabled ? 1 : 0);
+    w.u32(static_cast<uint32_t>(m.option_groups.size()));
+    for (const auto& g : m.option_groups) {
+        w.str(g.name);
+        w.u8(static_cast<uint8_t>(g.type));
+        w.u8(g.required ? 1 : 0);
+        w.u32(static_cast<uint32_t>(g.options.size()));
+        for (const auto& o : g.options) write_option(w, o);
+    }
+}
+
+DirStamp read_stamp(CacheReader& r) {
+    DirStamp s;
+    s.dev = r.u64(); s.ino = r.u64();
+    s.mtime_sec = static_cast<int64_t>(r.u64()); s.mtime_nsec = static_cast<int64_t>(r.u64());
+    return s;
+}
+
+ModOption read_option(CacheReader& r) {
+    ModOption o;
+    o.name = r.str();
+    o.path = r.str();
+    o.enabled = r.u8() != 0;
+    uint32_t n = r.count();
+    for (uint32_t i = 0; i < n && r.ok(); ++i) o.discovered_plugins.push_back(r.str());
+    return o;
+}
+
+ModDefinition read_mod(CacheReader& r) {
+    ModDefinition m;
+    m.name = r.str();
+    m.root_path = r.str();
+    m.enabled = r.u8() != 0;
+    uint32_t groups = r.count();
+    for (uint32_t i = 0; i < groups && r.ok(); ++i) {
+        ModOptionGroup g;
+        g.name = r.str();
+        g.type = static_cast<ModOptionGroup::Type>(r.u8());
+        g.required = r.u8() != 0;
+        uint32_t options = r.count();
+        for (uint32_t j = 0; j < options && r.ok(); ++j) g.options.push_back(read_option(r));
+        m.option_groups.push_back(std::move(g));
+    }
+    return m;
+}
+
+} // namespace
+
+// =============================================================================
+// SCAN INDEX
+// =============================================================================
+
+bool ScanIndex::load(const fs::path& index_file) {
+    m_entries.clear();
+    m_dirty = false;
+
+    std::ifstream file;
+    CacheOpen opened = open_cache_file(file, index_file, SCAN_INDEX_MAGIC, SCAN_INDEX_VERSION, "scan index");
+    if (opened != CacheOpen::OK) {
+        m_dirty = opened == CacheOpen::INCOMPATIBLE;
+        return false;
+    }
+
+    CacheReader r{file};
+    uint32_t entries = r.count();
+    for (uint32_t i = 0; i < entries && r.ok(); ++i) {
+        std::string key = r.str();
+        Entry entry;
+        entry.root_stamp = read_stamp(r);
+        uint32_t dirs = r.count();
+        for (uint32_t j = 0; j < dirs && r.ok(); ++j) {
+            std::string dir = r.str();
+            entry.listed_dirs.emplace_back(dir, read_stamp(r));
+        }
+        entry.mod = read_mod(r);
+        if (r.ok()) m_entries[key] = std::move(entry);
+    }
+
+    if (!r.ok()) {
+        LOG_WARN("Scan index at ", index_file.string(), " is corrupt, rebuilding.");
+        m_entries.clear();
+        m_dirty = true;
+        return false;
+    }
+
+    LOG_DEBUG("Loaded scan index with ", m_entries.size(), " entries.");
+    return true;
+}
+
+bool ScanIndex::save(const fs::path& index_file) {
+    bool saved = save_cache_file(index_file, SCAN_INDEX_MAGIC, SCAN_INDEX_VERSION, "scan index", [this](CacheWriter& w) {
+        w.u32(static_cast<uint32_t>(m_entries.size()));
+        for (const auto& pair : m_entries) {
+            w.str(pair.first);
+            write_stamp(w, pair.second.root_stamp);
+            w.u32(static_cast<uint32_t>(pair.second.listed_dirs.size()));
+            for (const auto& dir : pair.second.listed_dirs) {
+                w.str(dir.first);
+                write_stamp(w, dir.second);
+            }
+            write_mod(w, pair.second.mod);
+        }
+    });
+    if (saved) m_dirty = false;
+    return saved;
+}
+
+bool ScanIndex::lookup(const fs::path& mod_root, ModDefinition& out) const {
+    auto it = m_entries.find(mod_root.string());
+    if (it == m_entries.end()) return false;
+
+    const Entry& entry = it->second;
+    DirStamp current;
+    if (!read_dir_stamp(mod_root, current) || current != entry.root_stamp) return false;
+    for (const auto& dir : entry.listed_dirs) {
+        if (!read_dir_stamp(dir.first, current) || current != dir.second) return false;
+    }
+
+    out = entry.mod;
+    return true;
+}
+
+void ScanIndex::store(const fs::path& mod_root, const ModDefinition& mod, const std::vector<ListedDir>& listed_dirs) {
+    Entry entry;
+    bool have_root = false;
+    std::map<std::string, DirStamp> unique_dirs;
+    for (const auto& dir : listed_dirs) {
+        if (dir.path == mod_root) {
+            entry.root_stamp = dir.stamp;
+            have_root = true;
+        } else {
+            unique_dirs.emplace(dir.path.string(), dir.stamp);
+        }
+    }
+    if (!have_root) return;
+    entry.listed_dirs.assign(unique_dirs.begin(), unique_dirs.end());
+    entry.mod = mod;
+
+    m_entries[mod_root.string()] = std::move(entry);
+    m_dirty = true;
+}
+
+void ScanIndex::retain_only(const std::set<fs::path>& mod_roots) {
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (mod_roots.count(fs::path(it->first))) {
+            ++it;
+        } else {
+            it = m_entries.erase(it);
+            m_dirty = true;
+        }
+    }
+}
+
+void ScanIndex::erase(const fs::path& mod_root) {
+    if (m_entries.erase(mod_root.string())) m_dirty = true;
+}
+
+std::vector<fs::path> ScanIndex::dependent_dirs(const fs::path& mod_root) const {
+    std::vector<fs::path> dirs;
+    auto it = m_entries.find(mod_root.string());
+    if (it == m_entries.end()) return dirs;
+    dirs.push_back(mod_root);
+    for (const auto& dir : it->second.listed_dirs) dirs.emplace_back(dir.first);
+    return dirs;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "ModManager.h"
+#include "../utils/DirListing.h"
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+// Persistent, versioned cache of parsed mod directories, keyed by mod root.
+// An entry is reused only if the root and every directory the parser listed
+// still carry the same stamps as when it was parsed.
+class ScanIndex {
+public:
+    bool load(const fs::path& index_file);
+    bool save(const fs::path& index_file);
+
+    // Fills `out` and returns true if a still-valid entry exists for `mod_root`.
+    bool lookup(const fs::path& mod_root, ModDefinition& out) const;
+    // Records `mod` against the stamps its directories had when the parser
+    // listed them, so a directory that changed mid-scan is re-parsed next time.
+    void store(const fs::path& mod_root, const ModDefinition& mod, const std::vector<ListedDir>& listed_dirs);
+
+    // Drops entries for mod roots that are no longer present.
+    void retain_only(const std::set<fs::path>& mod_roots);
+    void erase(const fs::path& mod_root);
+
+    // The root plus every directory its cached definition depends on.
+    std::vector<fs::path> dependent_dirs(const fs::path& mod_root) const;
+
+    bool is_dirty() const { return m_dirty; }
+    size_t size() const { return m_entries.size(); }
+
+private:
+    struct Entry {
+        DirStamp root_stamp;
+        std::vector<std::pair<std::string, DirStamp>> listed_dirs;
+        ModDefinition mod;
+    };
+
+    std::map<std::string, Entry> m_entries;
+    bool m_dirty = false;
+};
@@ -122,6 +122,8 @@ void ScriptManager::scan_scripts(const fs::path& scripts_dir) {
         if (!sorters.empty()) {
             m_active_content_sorter = sorters[0]->script_path;
             LOG_INFO("No active content sorter set. Defaulting to: ", m_active_content_sorter.filename().string());
+        } else {
+            m_active_content_sorter = native_content_sorter();
         }
     }
     if (m_active_content_verifier.empty()) {
@@ -164,6 +166,7 @@ void ScriptManager::load_options(const fs::path& options_file) {
                     }
                 }
                 if (key == "active_content_sorter") {
+                    if (val == native_content_sorter().string()) m_active_content_sorter = native_content_sorter();
                     for (const auto& script : m_scripts) {
                         if (script.script_path.filename().string() == val) {
                             m_active_content_sorter = script.script_path;
@@ -304,6 +307,11 @@ void ScriptManager::set_active_data_sorter_path(const fs::path& script_path) {
 }
 
 
+const fs::path& ScriptManager::native_content_sorter() {
+    static const fs::path path("@native");
+    return path;
+}
+
 void ScriptManager::set_active_content_sorter_path(const fs::path& script_path) {
     m_active_content_sorter = script_path;
 }
@@ -63,6 +63,10 @@ public:
     ScriptDefinition* get_script_by_path(const fs::path& script_path);
     std::vector<ScriptDefinition*> get_scripts_by_registration(ScriptRegistration registration);
 
+    // Pseudo script path ("@native") that selects the built-in content sorter.
+    static const fs::path& native_content_sorter();
+    bool is_native_content_sorter_active() const { return m_active_content_sorter == native_content_sorter(); }
+
     fs::path get_active_data_sorter_path() const { return m_active_data_sorter; }
     fs::path get_active_content_sorter_path() const { return m_active_content_sorter; }
     fs::path get_active_content_verifier_path() const { return m_active_content_verifier; }
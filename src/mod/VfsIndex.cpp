@@ -0,0 +1,293 @@
+#include "VfsIndex.h"
+#include "../utils/DirListing.h"
+#include "../utils/Logger.h"
+#include "../utils/WorkerPool.h"
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <unordered_set>
+
+std::string VfsIndex::normalize(const std::string& relative_path) {
+    std::string result(relative_path);
+    for (auto& c : result) {
+        if (c == '\\') c = '/';
+        else if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return result;
+}
+
+// Collects every regular file below `data_path` as a normalized relative path.
+// Symlinked directories are followed, but none is entered twice (loops).
+static void walk_data_path(const fs::path& data_path, std::vector<std::string>& out) {
+    std::vector<std::pair<fs::path, std::string>> stack;
+    stack.emplace_back(data_path, std::string());
+    std::set<std::pair<uint64_t, uint64_t>> visited; // (dev, ino) of every directory entered
+    uint32_t cycles = 0;
+    DirListing listing;
+    while (!stack.empty()) {
+        auto dir = std::move(stack.back());
+        stack.pop_back();
+        if (!read_directory(dir.first, listing)) continue;
+        if (listing.stamp.ino != 0 && !visited.insert(std::make_pair(listing.stamp.dev, listing.stamp.ino)).second) {
+            cycles++;
+            continue;
+        }
+        for (const auto& entry : listing.entries) {
+            std::string relative = dir.second.empty() ? entry.name : dir.second + "/" + entry.name;
+            if (entry.type == DirEntry::DIRECTORY) {
+                stack.emplace_back(dir.first / entry.name, relative);
+            } else if (entry.type == DirEntry::FILE) {
+                out.push_back(VfsIndex::normalize(relative));
+            }
+        }
+    }
+    if (cycles) LOG_DEBUG("Skipped ", cycles, " directories already visited under ", data_path.string());
+}
+
+// =============================================================================
+// PATH ENTRIES
+// =============================================================================
+
+int VfsIndex::find_entry(const std::string& normalized, uint32_t hash) const {
+    uint32_t e = m_index.find(hash, [&](uint32_t candidate) {
+        const Entry& entry = m_entries[candidate];
+        return entry.path_length == normalized.size() &&
+               m_arena.compare(entry.path_offset, entry.path_length, normalized) == 0;
+    });
+    return e == HashIndex<uint32_t>::NONE ? -1 : static_cast<int>(e);
+}
+
+uint32_t VfsIndex::intern(const std::string& normalized) {
+    uint32_t hash = fnv1a_32(normalized);
+    int existing = find_entry(normalized, hash);
+    if (existing >= 0) return static_cast<uint32_t>(existing);
+
+    Entry entry;
+    entry.path_offset = static_cast<uint32_t>(m_arena.size());
+    entry.path_length = static_cast<uint32_t>(normalized.size());
+    entry.first_provider = NIL;
+    entry.winner = NIL;
+    m_arena += normalized;
+    m_entries.push_back(entry);
+
+    uint32_t index = static_cast<uint32_t>(m_entries.size() - 1);
+    m_index.insert(hash, index);
+    return index;
+}
+
+// =============================================================================
+// PROVIDERS
+// =============================================================================
+
+size_t VfsIndex::provider_count(const Entry& entry) const {
+    size_t count = 0;
+    for (uint32_t p = entry.first_provider; p != NIL; p = m_providers[p].next) ++count;
+    return count;
+}
+
+void VfsIndex::resolve_winner(uint32_t e) {
+    Entry& entry = m_entries[e];
+    entry.winner = NIL;
+    for (uint32_t p = entry.first_provider; p != NIL; p = m_providers[p].next) {
+        uint32_t source = m_providers[p].source;
+        if (entry.winner == NIL || m_sources[source].priority > m_sources[entry.winner].priority) {
+            entry.winner = source;
+        }
+    }
+}
+
+uint32_t VfsIndex::add_source(const fs::path& data_path, uint32_t priority, const std::vector<std::string>& files) {
+    uint32_t slot;
+    if (!m_free_sources.empty()) {
+        slot = m_free_sources.back();
+        m_free_sources.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(m_sources.size());
+        m_sources.emplace_back();
+    }
+    Source& source = m_sources[slot];
+    source.path = data_path;
+    source.priority = priority;
+    source.live = true;
+    source.dirty = false;
+    source.entries.clear();
+    source.entries.reserve(files.size());
+    m_source_slots[data_path.string()] = slot;
+
+    for (const auto& file : files) {
+        uint32_t e = intern(file);
+        // Names differing only in case collapse onto one entry; provide it once.
+        bool already = false;
+        for (uint32_t p = m_entries[e].first_provider; p != NIL; p = m_providers[p].next) {
+            if (m_providers[p].source == slot) { already = true; break; }
+        }
+        if (already) continue;
+
+        uint32_t node;
+        if (m_free_provider != NIL) {
+            node = m_free_provider;
+            m_free_provider = m_providers[node].next;
+        } else {
+            node = static_cast<uint32_t>(m_providers.size());
+            m_providers.emplace_back();
+        }
+        m_providers[node].source = slot;
+        m_providers[node].next = m_entries[e].first_provider;
+        m_entries[e].first_provider = node;
+        source.entries.push_back(e);
+        resolve_winner(e);
+    }
+    return slot;
+}
+
+void VfsIndex::remove_source(uint32_t slot) {
+    Source& source = m_sources[slot];
+    for (uint32_t e : source.entries) {
+        uint32_t* link = &m_entries[e].first_provider;
+        while (*link != NIL) {
+            uint32_t node = *link;
+            if (m_providers[node].source == slot) {
+                *link = m_providers[node].next;
+                m_providers[node].next = m_free_provider;
+                m_free_provider = node;
+                break;
+            }
+            link = &m_providers[node].next;
+        }
+        resolve_winner(e);
+    }
+    m_source_slots.erase(source.path.string());
+    source.entries.clear();
+    source.entries.shrink_to_fit();
+    source.live = false;
+    source.dirty = false;
+    m_free_sources.push_back(slot);
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+void VfsIndex::clear() {
+    *this = VfsIndex();
+}
+
+void VfsIndex::mark_dirty(const fs::path& data_path) {
+    auto it = m_source_slots.find(data_path.string());
+    if (it != m_source_slots.end()) m_sources[it->second].dirty = true;
+}
+
+void VfsIndex::sync(const std::vector<fs::path>& data_paths, WorkerPool* pool) {
+    auto start = std::chrono::steady_clock::now();
+
+    // Desired priority of each data path; a repeated entry keeps its first position.
+    std::unordered_map<std::string, uint32_t> wanted;
+    std::vector<fs::path> ordered;
+    for (const auto& p : data_paths) {
+        if (wanted.emplace(p.string(), static_cast<uint32_t>(ordered.size())).second) ordered.push_back(p);
+    }
+
+    // 1. Drop data paths that are gone or whose contents changed.
+    bool changed = false;
+    for (uint32_t slot = 0; slot < m_sources.size(); ++slot) {
+        const Source& source = m_sources[slot];
+        if (source.live && (source.dirty || !wanted.count(source.path.string()))) {
+            remove_source(slot);
+            changed = true;
+        }
+    }
+
+    // 2. Re-prioritise the survivors. Only sources that moved relative to the
+    // others can change a winner: keep the longest run that is still in the
+    // old relative order (LIS) and re-resolve the files of everything else.
+    std::vector<uint32_t> retained;
+    std::vector<size_t> missing;
+    for (size_t i = 0; i < ordered.size(); ++i) {
+        auto it = m_source_slots.find(ordered[i].string());
+        if (it != m_source_slots.end()) retained.push_back(it->second);
+        else missing.push_back(i);
+    }
+
+    std::vector<size_t> tails, parent(retained.size(), SIZE_MAX);
+    for (size_t i = 0; i < retained.size(); ++i) {
+        uint32_t key = m_sources[retained[i]].priority;
+        auto pos = std::lower_bound(tails.begin(), tails.end(), key,
+            [&](size_t idx, uint32_t k) { return m_sources[retained[idx]].priority < k; });
+        if (pos != tails.begin()) parent[i] = *(pos - 1);
+        if (pos == tails.end()) tails.push_back(i);
+        else *pos = i;
+    }
+    std::vector<char> in_order(retained.size(), 0);
+    for (size_t i = tails.empty() ? SIZE_MAX : tails.back(); i != SIZE_MAX; i = parent[i]) in_order[i] = 1;
+
+    for (uint32_t slot : retained) {
+        uint32_t priority = wanted[m_sources[slot].path.string()];
+        if (m_sources[slot].priority != priority) changed = true;
+        m_sources[slot].priority = priority;
+    }
+    for (size_t i = 0; i < retained.size(); ++i) {
+        if (in_order[i]) continue;
+        for (uint32_t e : m_sources[retained[i]].entries) resolve_winner(e);
+    }
+
+    // 3. Walk new data paths (the slow part) in parallel, then merge serially.
+    std::vector<std::vector<std::string>> files(missing.size());
+    auto walk = [&](size_t n) { walk_data_path(ordered[missing[n]], files[n]); };
+    if (pool) pool->parallel_for(missing.size(), walk);
+    else for (size_t n = 0; n < missing.size(); ++n) walk(n);
+    for (size_t n = 0; n < missing.size(); ++n) {
+        add_source(ordered[missing[n]], static_cast<uint32_t>(missing[n]), files[n]);
+        changed = true;
+    }
+
+    m_metrics.sources_scanned = missing.size();
+    if (!changed) return;
+
+    m_metrics.last_sync_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    update_metrics();
+    LOG_DEBUG("VFS index: ", m_metrics.files, " files (", m_metrics.shadowed, " overridden) across ",
+              m_metrics.sources, " data paths, walked ", missing.size(), " in ", m_metrics.last_sync_ms, " ms, ",
+              m_metrics.memory_bytes / 1024, " KiB.");
+}
+
+bool VfsIndex::resolve(const std::string& relative_path, fs::path* winner, std::vector<fs::path>* shadowed) const {
+    std::string normalized = normalize(relative_path);
+    int e = find_entry(normalized, fnv1a_32(normalized));
+    if (e < 0 || m_entries[e].winner == NIL) return false;
+
+    const Entry& entry = m_entries[e];
+    if (winner) *winner = m_sources[entry.winner].path;
+    if (shadowed) {
+        std::vector<uint32_t> losers;
+        for (uint32_t p = entry.first_provider; p != NIL; p = m_providers[p].next) {
+            if (m_providers[p].source != entry.winner) losers.push_back(m_providers[p].source);
+        }
+        std::sort(losers.begin(), losers.end(),
+            [&](uint32_t a, uint32_t b) { return m_sources[a].priority > m_sources[b].priority; });
+        shadowed->clear();
+        for (uint32_t s : losers) shadowed->push_back(m_sources[s].path);
+    }
+    return true;
+}
+
+void VfsIndex::update_metrics() {
+    m_metrics.files = 0;
+    m_metrics.shadowed = 0;
+    for (const auto& entry : m_entries) {
+        if (entry.first_provider == NIL) continue;
+        ++m_metrics.files;
+        if (m_providers[entry.first_provider].next != NIL) ++m_metrics.shadowed;
+    }
+
+    size_t bytes = m_arena.capacity() + m_entries.capacity() * sizeof(Entry) +
+                   m_index.memory_bytes() + m_providers.capacity() * sizeof(Provider) +
+                   m_sources.capacity() * sizeof(Source);
+    m_metrics.sources = 0;
+    for (const auto& source : m_sources) {
+        if (!source.live) continue;
+        ++m_metrics.sources;
+        bytes += source.entries.capacity() * sizeof(uint32_t) + source.path.string().capacity();
+    }
+    m_metrics.memory_bytes = bytes;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "../utils/HashIndex.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+class WorkerPool;
+
+struct VfsMetrics {
+    size_t files = 0;             // distinct normalized paths with at least one provider
+    size_t shadowed = 0;          // files provided by more than one data path
+    size_t sources = 0;           // data paths currently indexed
+    size_t sources_scanned = 0;   // data paths (re)walked by the last sync
+    size_t memory_bytes = 0;      // approximate heap use of the index
+    double last_sync_ms = 0.0;
+};
+
+// Model of OpenMW's virtual filesystem over an ordered list of data paths.
+// Relative paths are matched case-insensitively with '/' separators, and a
+// later data path overrides an earlier one, as in openmw.cfg.
+//
+// Paths are interned once into a single arena and looked up through an
+// open-addressing table; every (file, data path) pair is one 8-byte provider
+// node. sync() only walks data paths that are new or were marked dirty, and
+// only re-resolves winners for files whose providers were added, removed or
+// reordered.
+class VfsIndex {
+public:
+    // Brings the index in line with `data_paths` (lowest priority first).
+    // New and dirty data paths are walked, in parallel if a pool is given.
+    void sync(const std::vector<fs::path>& data_paths, WorkerPool* pool = nullptr);
+
+    // Forces `data_path` to be re-walked on the next sync (its contents changed).
+    void mark_dirty(const fs::path& data_path);
+    void clear();
+
+    // Looks up `relative_path` (any case, either separator). Returns false if
+    // no data path provides it. `shadowed` receives the losing providers,
+    // highest priority first.
+    bool resolve(const std::string& relative_path, fs::path* winner, std::vector<fs::path>* shadowed = nullptr) const;
+
+    // Calls fn(normalized_path, winner, provider_count) for every file.
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (const auto& entry : m_entries) {
+            if (entry.winner == NIL) continue;
+            fn(path_of(entry), m_sources[entry.winner].path, provider_count(entry));
+        }
+    }
+
+    const VfsMetrics& metrics() const { return m_metrics; }
+
+    // Lower-cases and converts '\' to '/'.
+    static std::string normalize(const std::string& relative_path);
+
+private:
+    static const uint32_t NIL = 0xFFFFFFFFu;
+
+    struct Entry {
+        uint32_t path_offset;
+        uint32_t path_length;
+        uint32_t first_provider; // NIL once the last provider is gone
+        uint32_t winner;         // source slot, or NIL
+    };
+    struct Provider {
+        uint32_t source;
+        uint32_t next;
+    };
+    struct Source {
+        fs::path path;
+        uint32_t priority = 0;
+        bool live = false;
+        bool dirty = false;
+        std::vector<uint32_t> entries; // entries this source provides
+    };
+
+    std::string path_of(const Entry& entry) const { return m_arena.substr(entry.path_offset, entry.path_length); }
+    size_t provider_count(const Entry& entry) const;
+
+    uint32_t intern(const std::string& normalized);
+    int find_entry(const std::string& normalized, uint32_t hash) const;
+
+    uint32_t add_source(const fs::path& data_path, uint32_t priority, const std::vector<std::string>& files);
+    void remove_source(uint32_t slot);
+    void resolve_winner(uint32_t entry);
+    void update_metrics();
+
+    std::string m_arena;                 // all interned paths, back to back
+    std::vector<Entry> m_entries;
+    HashIndex<uint32_t> m_index;         // entries by path hash
+    std::vector<Provider> m_providers;
+    uint32_t m_free_provider = NIL;      // free list threaded through Provider::next
+    std::vector<Source> m_sources;
+    std::vector<uint32_t> m_free_sources;
+    std::unordered_map<std::string, uint32_t> m_source_slots; // data path -> slot
+    VfsMetrics m_metrics;
+};
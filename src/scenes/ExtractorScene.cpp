@@ -14,24 +14,37 @@ ExtractorScene::ExtractorScene(StateMachine& machine, std::vector<ArchiveInfo> a
     : Scene(machine), m_archives_to_extract(std::move(archives)) {}
 
 ExtractorScene::~ExtractorScene() {
-    if (m_worker_thread.joinable()) {
-        m_worker_thread.join();
-    }
+    m_cancel.cancel(); // only still running if the app is shutting down
+    on_exit();
 }
 
 void ExtractorScene::on_enter() {
-    // We pass a const reference to the context from the state machine
-    m_worker_thread = std::thread(&ExtractorScene::extraction_worker, this, std::cref(m_state_machine.get_context()));
+    TaskScheduler& scheduler = m_state_machine.get_engine().get_scheduler();
+    const AppContext& ctx = m_state_machine.get_context();
+    m_worker_task = scheduler.submit([this, &ctx]() { extraction_worker(ctx); }, TaskScheduler::BULK);
+    // The "finished" flag flips on the main loop, never under render()'s feet.
+    std::weak_ptr<char> alive = m_lifetime;
+    scheduler.then_on_main(m_worker_task, [this, alive]() {
+        if (alive.expired()) return;
+        m_is_finished = true;
+    });
 }
 
 void ExtractorScene::on_exit() {
-    if (m_worker_thread.joinable()) {
-        m_worker_thread.join();
+    if (m_worker_task) {
+        m_state_machine.get_engine().get_scheduler().wait(m_worker_task);
+        m_worker_task.reset();
     }
 }
 
 void ExtractorScene::handle_event(SDL_Event& e) {
-    if (m_is_finished) {
+    if (!m_is_finished) {
+        // B while running asks the worker to stop after the current step.
+        if ((e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE) ||
+            (e.type == SDL_CONTROLLERBUTTONDOWN && e.cbutton.button == SDL_CONTROLLER_BUTTON_B)) {
+            m_cancel.cancel();
+        }
+    } else {
         if ((e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE) ||
             (e.type == SDL_CONTROLLERBUTTONDOWN && e.cbutton.button == SDL_CONTROLLER_BUTTON_B)) {
             // Pop this scene and return to the previous one (ModManagerScene)
@@ -40,23 +53,31 @@ void ExtractorScene::handle_event(SDL_Event& e) {
     }
 }
 
+void ExtractorScene::update() {
+    m_log_queue.drain([&](std::string&& line) { m_log_lines.push_back(std::move(line)); });
+    m_status_queue.drain([&](std::string&& status) { m_status_message = std::move(status); });
+}
+
 void ExtractorScene::render() {
     ImGui::SetNextWindowPos(ImVec2(0, 0));
     ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
     ImGui::Begin("Extractor", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove);
 
     ImGui::Text("%s", m_status_message.c_str());
+    ProgressSink::Snapshot progress = m_progress.snapshot();
+    if (progress.total > 0) {
+        std::string overlay = std::to_string(progress.done) + " / " + std::to_string(progress.total);
+        ImGui::ProgressBar(static_cast<float>(progress.done) / static_cast<float>(progress.total), ImVec2(-1, 0),
+                           overlay.c_str());
+    }
     ImGui::Separator();
 
     ImGui::BeginChild("LogPanel", ImVec2(0, -50), true, ImGuiWindowFlags_HorizontalScrollbar);
-    {
-        std::lock_guard<std::mutex> lock(m_log_mutex);
-        for (const auto& line : m_log_lines) {
-            ImGui::TextWrapped("%s", line.c_str());
-        }
-        if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
-            ImGui::SetScrollHereY(1.0f);
-        }
+    for (const auto& line : m_log_lines) {
+        ImGui::TextWrapped("%s", line.c_str());
+    }
+    if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
+        ImGui::SetScrollHereY(1.0f);
     }
     ImGui::EndChild();
 
@@ -64,6 +85,10 @@ void ExtractorScene::render() {
         if (ImGui::Button("Back to Mod Manager", ImVec2(ImGui::GetContentRegionAvail().x, 40))) {
             m_state_machine.pop_state();
         }
+    } else if (m_cancel.is_cancelled()) {
+        ImGui::TextDisabled("Cancelling after the current archive step...");
+    } else if (ImGui::Button("Cancel (B)", ImVec2(ImGui::GetContentRegionAvail().x, 40))) {
+        m_cancel.cancel();
     }
 
     ImGui::End();
@@ -71,11 +96,10 @@ void ExtractorScene::render() {
 
 void ExtractorScene::extraction_worker(const AppContext& ctx) {
     auto add_log = [&](const std::string& msg) {
-        std::lock_guard<std::mutex> lock(m_log_mutex);
         std::cout << msg << std::endl;
-        m_log_lines.push_back(msg);
-        m_status_message = "Extracting...";
+        m_log_queue.push(msg);
     };
+    m_status_queue.push("Extracting...");
 
     try {
         const std::string SEVEN_ZIP_EXEC = ctx.exec_7zz.string();
@@ -84,8 +108,7 @@ void ExtractorScene::extraction_worker(const AppContext& ctx) {
         add_log("Starting mod extraction process...");
         if (m_archives_to_extract.empty()) {
             add_log("No archives selected for extraction.");
-            m_status_message = "Finished: Nothing to extract.";
-            m_is_finished = true;
+            m_status_queue.push("Finished: Nothing to extract.");
             return;
         }
 
@@ -93,13 +116,29 @@ void ExtractorScene::extraction_worker(const AppContext& ctx) {
 
         add_log("Found " + std::to_string(m_archives_to_extract.size()) + " archives to process.");
 
+        m_progress.begin("Extracting archives", m_archives_to_extract.size());
         for (const auto& archive_info : m_archives_to_extract) {
+            if (m_cancel.is_cancelled()) {
+                add_log("Extraction cancelled; remaining archives skipped.");
+                break;
+            }
             fs::path output_dir = archive_info.target_data_path;
 
             add_log("------------------------------------------");
             add_log("Processing: " + archive_info.archive_path.filename().string());
             add_log("-> Target: " + output_dir.string());
 
+            // Classify the layout up front so odd archives are flagged before we extract.
+            ModDefinition layout;
+            if (ArchiveManager::preview_layout(archive_info, SEVEN_ZIP_EXEC, layout)) {
+                std::string groups;
+                for (const auto& group : layout.option_groups) {
+                    groups += (groups.empty() ? "" : ", ") + group.name + " (" + std::to_string(group.options.size()) + ")";
+                }
+                if (groups.empty()) add_log("!! No data folders or plugins detected; this mod may need manual setup.");
+                else add_log("-> Layout: " + groups);
+            }
+
             if (fs::exists(output_dir)) {
                 add_log("Removing existing directory...");
                 boost::system::error_code ec;
@@ -120,7 +159,7 @@ void ExtractorScene::extraction_worker(const AppContext& ctx) {
 
             std::string current_line;
             int ch;
-            while ((ch = fgetc(pipe)) != EOF) {
+            while (!m_cancel.is_cancelled() && (ch = fgetc(pipe)) != EOF) {
                 if (ch == '\n' || ch == '\r') {
                     if (!current_line.empty()) {
                         add_log("  " + current_line);
@@ -133,7 +172,15 @@ void ExtractorScene::extraction_worker(const AppContext& ctx) {
             if (!current_line.empty()) {
                 add_log("  " + current_line);
             }
-            pclose(pipe);
+            pclose(pipe); // with the pipe closed, 7zz stops at its next write
+
+            if (m_cancel.is_cancelled()) {
+                // Never leave a half-extracted folder that looks installed.
+                add_log("Cancelled; removing partial " + output_dir.string());
+                boost::system::error_code ec;
+                fs::remove_all(output_dir, ec);
+                break;
+            }
 
             // --- NEW: Write the marker file on success ---
             fs::create_directories(output_dir); // Ensure it exists
@@ -146,10 +193,11 @@ void ExtractorScene::extraction_worker(const AppContext& ctx) {
             } else {
                 add_log("!! ERROR: Could not write version marker file to " + marker_file_path.string());
             }
+            m_progress.advance();
         }
 
         add_log("------------------------------------------");
-        add_log("Extraction complete!");
+        add_log(m_cancel.is_cancelled() ? "Extraction cancelled." : "Extraction complete!");
 
     } catch (const fs::filesystem_error& e) {
         add_log("Filesystem Error: " + std::string(e.what()));
@@ -157,6 +205,5 @@ void ExtractorScene::extraction_worker(const AppContext& ctx) {
         add_log("General Error: " + std::string(e.what()));
     }
     
-    m_status_message = "Finished. Press (B) to return.";
-    m_is_finished = true;
+    m_status_queue.push("Finished. Press (B) to return.");
 }
@@ -1,10 +1,12 @@
 #pragma once
 #include "Scene.h"
 #include "../mod/ArchiveManager.h" // For ArchiveInfo
+#include "../utils/Progress.h"
+#include "../utils/SpscQueue.h"
+#include "../utils/TaskScheduler.h"
 #include <vector>
 #include <string>
-#include <thread>
-#include <mutex>
+#include <memory>
 
 class ExtractorScene : public Scene {
 public:
@@ -15,6 +17,7 @@ public:
     void on_enter() override;
     void on_exit() override;
     void handle_event(SDL_Event& e) override;
+    void update() override;
     void render() override;
 
 private:
@@ -22,8 +25,14 @@ private:
     void extraction_worker(const AppContext& ctx);
 
     std::vector<ArchiveInfo> m_archives_to_extract;
-    std::thread m_worker_thread;
-    std::mutex m_log_mutex;
+    TaskHandle m_worker_task;
+    CancelToken m_cancel = CancelToken::make();
+    ProgressSink m_progress;
+    // Expires with the scene, so a late main-loop continuation can tell it is gone.
+    std::shared_ptr<char> m_lifetime = std::make_shared<char>(0);
+    // Worker -> UI; update() moves them into the UI-only copies below.
+    SpscQueue<std::string> m_log_queue;
+    SpscQueue<std::string> m_status_queue;
     std::vector<std::string> m_log_lines;
     std::string m_status_message = "Initializing...";
     bool m_is_finished = false;
@@ -0,0 +1,50 @@
+#include "LoadingScene.h"
+#include "MainMenuScene.h"
+#include "../core/StateMachine.h"
+#include "imgui.h"
+
+LoadingScene::LoadingScene(StateMachine& machine) : Scene(machine) {}
+
+void LoadingScene::update() {
+    if (m_done) return;
+    ModEngine& engine = m_state_machine.get_engine();
+    if (engine.init_phase_done(InitPhase::CONFIG) || !engine.get_init_error().empty()) {
+        m_done = true;
+        m_state_machine.change_scene(std::make_unique<MainMenuScene>(m_state_machine));
+    }
+}
+
+void LoadingScene::render() {
+    std::string title = "OpenMW ESMM";
+    ImGui::SetNextWindowPos(ImVec2(0, 0));
+    ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+    ImGui::Begin("Loading", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoInputs);
+
+    ImGui::SetCursorPosY(ImGui::GetCursorPosY() + 50);
+    auto windowWidth = ImGui::GetWindowSize().x;
+    ImGui::SetCursorPosX((windowWidth - ImGui::CalcTextSize(title.c_str()).x) * 0.5f);
+    ImGui::Text("%s", title.c_str());
+    ImGui::SetCursorPosY(ImGui::GetCursorPosY() + 20);
+    ImGui::Separator();
+    ImGui::Dummy(ImVec2(0.0f, 50.0f));
+
+    // One line per phase: done, running (with a spinner) or pending.
+    static const char spinner[] = "|/-\\";
+    InitPhase current = m_state_machine.get_engine().init_phase();
+    for (int i = 0; i < static_cast<int>(InitPhase::READY); ++i) {
+        InitPhase phase = static_cast<InitPhase>(i);
+        std::string line = init_phase_name(phase);
+        if (phase < current) {
+            line = "[done] " + line;
+        } else if (phase == current) {
+            line = std::string("[ ") + spinner[static_cast<int>(ImGui::GetTime() * 8) % 4] + "  ] " + line + "...";
+        } else {
+            line = "[    ] " + line;
+        }
+        ImGui::SetCursorPosX((windowWidth - ImGui::CalcTextSize(line.c_str()).x) * 0.5f);
+        if (phase > current) ImGui::TextDisabled("%s", line.c_str());
+        else ImGui::Text("%s", line.c_str());
+    }
+
+    ImGui::End();
+}
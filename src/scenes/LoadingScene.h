@@ -0,0 +1,14 @@
+#pragma once
+#include "Scene.h"
+
+// Shown while the engine initializes in the background. Hands over to the
+// main menu as soon as the config has been parsed.
+class LoadingScene : public Scene {
+public:
+    LoadingScene(StateMachine& machine);
+    void update() override;
+    void render() override;
+
+private:
+    bool m_done = false;
+};
@@ -12,6 +12,12 @@
 
 MainMenuScene::MainMenuScene(StateMachine& machine) : Scene(machine) {
     m_options = {"Load Morrowind", "Mod Manager", "Utilities", "Settings", "Quit"};
+    // Scripts write a temporary openmw.cfg from the content lists; the Mod
+    // Manager needs the mods and archives (the header phase after them only
+    // touches the thread-safe header cache). The rest only need what the
+    // loading scene already waited for.
+    m_requires = {InitPhase::CONTENT_LISTS, InitPhase::ARCHIVES, InitPhase::CONTENT_LISTS,
+                  InitPhase::CONFIG, InitPhase::CONFIG};
     set_default = true;
 }
 
@@ -28,6 +34,14 @@ void MainMenuScene::handle_event(SDL_Event& e) {
 }
 
 void MainMenuScene::on_select(int i) {
+    const std::string init_error = m_state_machine.get_engine().get_init_error();
+    if (!init_error.empty() && (i == 0 || i == 1 || i == 2)) {
+        m_state_machine.push_scene(std::make_unique<AlertScene>(
+            m_state_machine, "Initialization Failed", init_error));
+        return;
+    }
+    if (!m_state_machine.get_engine().init_phase_done(m_requires[i])) return;
+
     switch (i) {
         case 0: { // Load Morrowind
             auto& engine = m_state_machine.get_engine();
@@ -94,6 +108,9 @@ void MainMenuScene::render() {
     ImGui::Separator();
     ImGui::Dummy(ImVec2(0.0f, 50.0f)); // More vertical space
 
+    ModEngine& engine = m_state_machine.get_engine();
+    bool has_error = !engine.get_init_error().empty();
+
     // --- Menu Options ---
     for (size_t i = 0; i < m_options.size(); ++i)
     {
@@ -107,12 +124,24 @@ void MainMenuScene::render() {
             set_default = false;
         }
 
+        // Options whose data is still loading stay greyed out.
+        bool ready = engine.init_phase_done(m_requires[i]) || has_error;
+        ImGui::BeginDisabled(!ready);
         // The selectable item
         if (ImGui::Selectable(m_options[i].c_str()))
         {
             // We can also trigger selection by clicking now
             on_select(i);
         }
+        ImGui::EndDisabled();
+    }
+
+    // --- Background loading status ---
+    if (!engine.init_phase_done(InitPhase::ARCHIVES) && !has_error) {
+        std::string status = std::string(init_phase_name(engine.init_phase())) + "...";
+        ImGui::Dummy(ImVec2(0.0f, 30.0f));
+        ImGui::SetCursorPosX((windowWidth - ImGui::CalcTextSize(status.c_str()).x) * 0.5f);
+        ImGui::TextDisabled("%s", status.c_str());
     }
 
     ImGui::End();
@@ -1,5 +1,6 @@
 #pragma once
 #include "Scene.h"
+#include "../core/ModEngine.h"
 #include <string>
 #include <vector>
 
@@ -11,5 +12,6 @@ public:
 private:
     void on_select(int i);
     std::vector<std::string> m_options;
+    std::vector<InitPhase> m_requires; // engine phase each option waits for
     bool set_default;
 };
@@ -2,41 +2,33 @@
 #include "ExtractorScene.h"
 #include "../core/StateMachine.h"
 #include "../core/ModEngine.h"
+#include "../utils/StatCache.h"
 #include "imgui.h"
 #include "imgui_internal.h"
 #include <algorithm>
+#include <cstring>
 #include <vector>
 #include <fstream>
 #include <iostream>
 #include <set>
 
-void handle_option_check(ModOption& option) {
-    if (!option.enabled) return;
-    if (option.parent_group && option.parent_group->type == ModOptionGroup::SINGLE_CHOICE) {
-        for (auto& other_option : option.parent_group->options) {
-            if (&other_option != &option) other_option.enabled = false;
-        }
-    }
-}
-
 // --- NEW DISPLAY HELPER FUNCTION ---
 static std::string get_display_path(const fs::path& path, const ModManager& mod_manager, const AppContext& ctx) {
-    for (const auto& mod : mod_manager.mod_definitions) {
-        for (const auto& group : mod.option_groups) {
-            for (const auto& option : group.options) {
-                if (option.path == path) {
-                    // Found the owner mod and option
-                    bool is_external = mod.root_path.string().find(ctx.path_mod_data.string()) != 0;
-                    
-                    if (mod.name == "The Elder Scrolls III: Morrowind") {
-                        return mod.name + "/" + option.name;
-                    }
-
-                    std::string relative_part = path.lexically_relative(mod.root_path).string();
-                    return (is_external ? "[External] " : "") + mod.name + "/" + relative_part;
-                }
-            }
+    const ModStore& store = mod_manager.mod_store;
+    uint32_t option = mod_manager.find_option_owner(path);
+    if (option != ModStore::NONE) {
+        // Found the owner mod and option
+        uint32_t mod = store.option_mod(option);
+        std::string mod_name = store.mod_name(mod);
+        std::string root_path = store.mod_root(mod);
+        bool is_external = root_path.find(ctx.path_mod_data.string()) != 0;
+
+        if (mod_name == "The Elder Scrolls III: Morrowind") {
+            return mod_name + "/" + store.option_name(option);
         }
+
+        std::string relative_part = path.lexically_relative(root_path).string();
+        return (is_external ? "[External] " : "") + mod_name + "/" + relative_part;
     }
     // Fallback if no owner is found
     return path.string();
@@ -51,6 +43,25 @@ struct ModManagerScene::State {
     bool focus_request_data = false;
     bool focus_request_content = false;
     std::vector<char> archive_selection;
+    std::vector<fs::path> archive_selection_paths; // archive_path per archive_selection slot
+    std::vector<std::string> data_path_labels;
+    std::vector<fs::path> pending_mod_data;        // refresh once we're back on top
+    std::vector<fs::path> pending_delete;          // deleted by update() as an engine operation
+    bool pending_conflict_check = false;           // likewise
+    bool pending_vfs_rebuild = false;              // likewise; the first sync walks every data path
+    bool show_identical_conflicts = false;
+    std::vector<uint32_t> conflict_rows;           // shown entries of the conflict report
+    size_t identical_conflicts = 0;
+    bool conflict_rows_valid = false;
+    bool pending_dirty_check = false;              // started from update() too
+    std::vector<std::pair<uint32_t, uint32_t>> dirty_rows; // (plugin, edit) of the dirty report
+    bool dirty_rows_valid = false;
+    bool pending_clean = false;                    // cleans every plugin with ITMs
+    bool pending_restore = false;
+    bool pending_config_reload = false;            // openmw.cfg was edited elsewhere
+    bool show_reload_prompt = false;               // ...while our lists had unsaved edits
+    EngineGenerations seen;                        // what the derived state above was built from
+    bool labels_valid = false;
     bool show_save_warning = false;
     bool needs_refresh = true;
 };
@@ -66,12 +77,13 @@ void ModManagerScene::save_and_exit() {
 }
 
 void ModManagerScene::fix_load_order_and_save() {
-    ModManager& mod_manager = m_state_machine.get_engine().get_mod_manager_mut();
+    ModEngine& engine = m_state_machine.get_engine();
+    ModManager& mod_manager = engine.get_mod_manager_mut();
 
     // Fix data paths
     auto& data_paths = mod_manager.active_data_paths;
     auto it_data = std::find_if(data_paths.begin(), data_paths.end(), [](const fs::path& p) {
-        return fs::exists(p / "Morrowind.esm");
+        return StatCache::instance().exists(p / "Morrowind.esm");
     });
     if (it_data != data_paths.end() && it_data != data_paths.begin()) {
         fs::path game_data_path = *it_data;
@@ -81,7 +93,7 @@ void ModManagerScene::fix_load_order_and_save() {
 
     // Fix content files
     auto& content_files = mod_manager.active_content_files;
-    const std::vector<std::string> masters = {"Morrowind.esm", "Tribunal.esm", "Bloodmoon.esm"};
+    const std::vector<StringId> masters = {intern("Morrowind.esm"), intern("Tribunal.esm"), intern("Bloodmoon.esm")};
 
     // Iterate forwards to find, then backwards to insert
     for (int i = masters.size() - 1; i >= 0; --i) {
@@ -95,12 +107,164 @@ void ModManagerScene::fix_load_order_and_save() {
             content_files.insert(content_files.begin(), master_file);
         }
     }
-    
+    // Republish, so the snapshot matches what is about to be saved.
+    engine.touch_active_lists();
+
     save_and_exit();
 }
 
 void ModManagerScene::on_enter() {
-    p_state->needs_refresh = true;
+    // With a live watcher, pending changes are picked up in update() instead.
+    p_state->needs_refresh = !m_state_machine.get_engine().has_fs_watcher();
+}
+
+// Rebuilds the scene's derived state for whatever changed in the engine
+// since it was last built.
+void ModManagerScene::sync_with_engine() {
+    ModEngine& engine = m_state_machine.get_engine();
+    const EngineGenerations& gen = engine.get_generations();
+
+    if (gen.archives != p_state->seen.archives) {
+        // Keep the checked archives checked when the list is rebuilt underneath us.
+        const auto& archives = engine.get_archive_manager().archives;
+        std::set<fs::path> selected;
+        for (size_t i = 0; i < p_state->archive_selection_paths.size() && i < p_state->archive_selection.size(); ++i) {
+            if (p_state->archive_selection[i]) selected.insert(p_state->archive_selection_paths[i]);
+        }
+        p_state->archive_selection.assign(archives.size(), 0);
+        p_state->archive_selection_paths.clear();
+        for (size_t i = 0; i < archives.size(); ++i) {
+            p_state->archive_selection_paths.push_back(archives[i].archive_path);
+            if (selected.count(archives[i].archive_path)) p_state->archive_selection[i] = 1;
+        }
+    }
+    if (gen.mods != p_state->seen.mods || gen.active_lists != p_state->seen.active_lists) {
+        p_state->labels_valid = false;
+    }
+    if (gen.conflicts != p_state->seen.conflicts) {
+        p_state->conflict_rows_valid = false;
+    }
+    if (gen.dirty != p_state->seen.dirty) {
+        p_state->dirty_rows_valid = false;
+    }
+    p_state->seen = gen;
+}
+
+void ModManagerScene::update() {
+    ModEngine& engine = m_state_machine.get_engine();
+    if (engine.is_busy()) return; // a rescan or deletion owns the engine state
+    if (!p_state->pending_delete.empty()) {
+        std::vector<fs::path> paths = std::move(p_state->pending_delete);
+        p_state->pending_delete.clear();
+        engine.start_operation("Deleting mod data", [&engine, paths](const CancelToken& cancel, ProgressSink& progress) {
+            try {
+                engine.delete_mod_data(paths, cancel, &progress);
+            } catch (const OperationCancelled&) {
+                // Still pick up whatever is left of the folders below.
+            }
+            // --- Immediately refresh just the deleted folders ---
+            engine.refresh_mod_data(paths);
+            cancel.throw_if_cancelled();
+        });
+        return;
+    }
+    if (p_state->pending_vfs_rebuild) {
+        p_state->pending_vfs_rebuild = false;
+        engine.start_operation("Rebuilding VFS index", [&engine](const CancelToken&, ProgressSink&) {
+            engine.get_vfs_index();
+        });
+        return;
+    }
+    if (p_state->pending_conflict_check) {
+        p_state->pending_conflict_check = false;
+        auto inputs = std::make_shared<PluginCheckInputs>(engine.capture_plugin_check_inputs());
+        engine.start_operation("Checking record conflicts", [&engine, inputs](const CancelToken& cancel, ProgressSink& progress) {
+            engine.check_conflicts(*inputs, cancel, &progress);
+        });
+        return;
+    }
+    if (p_state->pending_dirty_check) {
+        p_state->pending_dirty_check = false;
+        // Copies of since-updated originals go first, so the check sees those.
+        if (engine.drop_stale_cleaned_plugins()) engine.refresh_mod_data({engine.get_cleaned_plugins_dir()});
+        auto inputs = std::make_shared<PluginCheckInputs>(engine.capture_plugin_check_inputs());
+        engine.start_operation("Finding dirty edits", [&engine, inputs](const CancelToken& cancel, ProgressSink& progress) {
+            engine.check_dirty_plugins(*inputs, cancel, &progress);
+        });
+        return;
+    }
+    if (p_state->pending_clean) {
+        p_state->pending_clean = false;
+        std::vector<StringId> plugins;
+        for (const auto& plugin : engine.get_dirty_report().plugins) {
+            if (plugin->identical) plugins.push_back(plugin->plugin);
+        }
+        auto inputs = std::make_shared<PluginCheckInputs>(engine.capture_plugin_check_inputs());
+        engine.start_operation("Cleaning plugins", [&engine, inputs, plugins](const CancelToken& cancel, ProgressSink& progress) {
+            engine.clean_dirty_plugins(*inputs, plugins, cancel, &progress);
+        });
+        return;
+    }
+    if (p_state->pending_restore) {
+        p_state->pending_restore = false;
+        engine.start_operation("Restoring original plugins", [&engine](const CancelToken& cancel, ProgressSink& progress) {
+            engine.restore_original_plugins(cancel, &progress);
+        });
+        return;
+    }
+    if (p_state->pending_config_reload) {
+        p_state->pending_config_reload = false;
+        engine.start_operation("Reloading openmw.cfg", [&engine](const CancelToken& cancel, ProgressSink& progress) {
+            engine.reload_configuration(cancel, &progress);
+        });
+        return;
+    }
+    if (!p_state->pending_mod_data.empty()) {
+        engine.refresh_mod_data(p_state->pending_mod_data);
+        p_state->pending_mod_data.clear();
+    }
+    switch (engine.process_fs_changes()) {
+    case FsChangeResult::OVERFLOWED:
+        p_state->needs_refresh = true; // rescanned as an operation by render()
+        break;
+    case FsChangeResult::CONFIG_CHANGED:
+        // Don't throw away edits the user hasn't saved without asking.
+        if (engine.has_unsaved_list_changes()) p_state->show_reload_prompt = true;
+        else p_state->pending_config_reload = true;
+        break;
+    default:
+        break;
+    }
+    sync_with_engine();
+}
+
+// Shown instead of the tabs while a long engine operation runs.
+void ModManagerScene::render_operation_progress() {
+    ModEngine& engine = m_state_machine.get_engine();
+    ProgressSink::Snapshot progress = engine.get_operation_progress();
+
+    ImGui::SetNextWindowPos(ImVec2(0, 0));
+    ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+    ImGui::Begin("Mod Manager", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove);
+    ImGui::Text("%s", engine.get_operation_label().c_str());
+    ImGui::Separator();
+    ImGui::Text("%s", progress.stage.c_str());
+    if (progress.total > 0) {
+        float fraction = static_cast<float>(progress.done) / static_cast<float>(progress.total);
+        std::string overlay = std::to_string(progress.done) + " / " + std::to_string(progress.total);
+        ImGui::ProgressBar(fraction, ImVec2(-1, 0), overlay.c_str());
+    } else {
+        // Unknown total: show a count instead of a bar.
+        ImGui::Text("%llu done", static_cast<unsigned long long>(progress.done));
+    }
+
+    ImGui::Spacing();
+    if (engine.is_operation_cancelled()) {
+        ImGui::TextDisabled("Cancelling...");
+    } else if (ImGui::Button("Cancel", ImVec2(ImGui::GetContentRegionAvail().x, 40))) {
+        engine.cancel_operation();
+    }
+    ImGui::End();
 }
 
 // handle_event is empty because all logic is in render
@@ -114,11 +278,16 @@ void ModManagerScene::render() {
     const AppContext& ctx = m_state_machine.get_context();
 
     if (p_state->needs_refresh) {
-        engine.rescan_archives();
-        engine.rescan_mods();
-        p_state->archive_selection.assign(engine.get_archive_manager().archives.size(), 0);
-        p_state->needs_refresh = false;
+        p_state->needs_refresh = !engine.start_operation("Rescanning mods", [&engine](const CancelToken& cancel, ProgressSink& progress) {
+            engine.rescan_archives(cancel, &progress);
+            engine.rescan_mods(cancel, &progress);
+        });
+    }
+    if (engine.is_busy()) {
+        render_operation_progress();
+        return;
     }
+    sync_with_engine();
 
     bool state_changed = false;
 
@@ -142,7 +311,8 @@ void ModManagerScene::render() {
                     if (p_state->archive_selection[i]) to_extract.push_back(archive_manager.archives[i]);
                 }
                 if (!to_extract.empty()) {
-                    p_state->needs_refresh = true;
+                    // Picked up by update() once the extractor is popped.
+                    for (const auto& archive : to_extract) p_state->pending_mod_data.push_back(archive.target_data_path);
                     m_state_machine.push_scene(std::make_unique<ExtractorScene>(m_state_machine, to_extract));
                 }
             }
@@ -153,17 +323,14 @@ void ModManagerScene::render() {
                 for(size_t i = 0; i < engine.get_archive_manager().archives.size(); ++i) {
                     if (p_state->archive_selection[i]) {
                         const auto& archive = engine.get_archive_manager().archives[i];
-                        if (fs::exists(archive.target_data_path)) {
+                        if (StatCache::instance().exists(archive.target_data_path)) {
                             paths_to_delete.push_back(archive.target_data_path);
                         }
                     }
                 }
 
-                if (!paths_to_delete.empty()) {
-                    engine.delete_mod_data(paths_to_delete);
-                    // --- Immediately trigger a refresh ---
-                    p_state->needs_refresh = true; 
-                }
+                // Started from update(), so the rest of this frame still sees a quiet engine.
+                if (!paths_to_delete.empty()) p_state->pending_delete = paths_to_delete;
             }
             // --- NEW: Color-coded toggle buttons ---
             if (has_new_mods) {
@@ -222,51 +389,54 @@ void ModManagerScene::render() {
         if (ImGui::BeginTabItem("Mod Configuration")) {
             ImGui::BeginChild("ModTree", ImVec2(0, -50), true);
             
-            for (auto& mod : mod_manager.mod_definitions) {
+            ModStore& store = mod_manager.mod_store;
+            for (uint32_t mod = 0; mod < store.mod_count(); ++mod) {
+                const char* mod_name = store.mod_name(mod);
                 // --- THIS IS THE FIX ---
                 // Identify if this is the special, non-disable-able base game mod.
-                bool is_base_game_mod = (mod.name == "The Elder Scrolls III: Morrowind");
+                bool is_base_game_mod = (std::strcmp(mod_name, "The Elder Scrolls III: Morrowind") == 0);
 
                 if (is_base_game_mod) {
                     ImGui::BeginDisabled(); // Disable the widget
                 }
 
-                if (ImGui::Checkbox(mod.name.c_str(), &mod.enabled)) {
+                bool mod_enabled = store.mod_enabled(mod);
+                ImGui::PushID(static_cast<int>(mod));
+                if (ImGui::Checkbox(mod_name, &mod_enabled)) {
+                    mod_manager.apply_mod_toggle(mod, mod_enabled);
                     state_changed = true;
-                    if (mod.enabled) {
-                        for (auto& group : mod.option_groups) {
-                            if (group.required && !group.options.empty()) group.options.front().enabled = true;
-                        }
-                    }
                 }
+                ImGui::PopID();
 
                 if (is_base_game_mod) {
-                    mod.enabled = true; // Forcibly re-enable it just in case.
+                    store.set_mod_enabled(mod, true); // Forcibly re-enable it just in case.
                     ImGui::EndDisabled(); // Re-enable widgets for the next item
                 }
 
-                if (mod.enabled) {
+                if (store.mod_enabled(mod)) {
                     ImGui::Indent();
-                    for (auto& group : mod.option_groups) {
-                        ImGui::TextDisabled("  - %s -", group.name.c_str());
+                    for (uint32_t group = store.mod_groups_begin(mod); group < store.mod_groups_end(mod); ++group) {
+                        ImGui::TextDisabled("  - %s -", store.group_name(group));
                         ImGui::Indent();
-                        for (auto& option : group.options) {
+                        for (uint32_t option = store.group_options_begin(group); option < store.group_options_end(group); ++option) {
                             // --- THIS IS THE SECOND PART OF THE FIX ---
                             // Check if this specific option is the base game's data path.
-                            bool is_base_data_option = is_base_game_mod && fs::exists(option.path / "Morrowind.esm");
+                            bool is_base_data_option = is_base_game_mod && StatCache::instance().exists(fs::path(store.option_path(option)) / "Morrowind.esm");
 
                             if (is_base_data_option) {
                                 ImGui::BeginDisabled();
                             }
 
-                            std::string unique_id = option.name + "##" + mod.name + group.name;
-                            if (ImGui::Checkbox(unique_id.c_str(), &option.enabled)) {
-                                handle_option_check(option);
+                            bool option_enabled = store.option_enabled(option);
+                            ImGui::PushID(static_cast<int>(option));
+                            if (ImGui::Checkbox(store.option_name(option), &option_enabled)) {
+                                mod_manager.apply_option_toggle(option, option_enabled);
                                 state_changed = true;
                             }
+                            ImGui::PopID();
 
                             if (is_base_data_option) {
-                                option.enabled = true; // And forcibly re-enable it.
+                                store.set_option_enabled(option, true); // And forcibly re-enable it.
                                 ImGui::EndDisabled();
                             }
                         }
@@ -288,7 +458,6 @@ void ModManagerScene::render() {
                 ImGui::SameLine();
                 if (ImGui::Button("Sort Content")) {
                     engine.run_active_sorter(ScriptRegistration::SORT_CONTENT);
-                    p_state->needs_refresh = true;
                 }
             }
 
@@ -317,9 +486,10 @@ void ModManagerScene::render() {
                     ImGui::SetItemDefaultFocus();
                     p_state->focus_request_content = false;
                 }
-                if (ImGui::Checkbox(content.name.c_str(), &content.enabled)) {
+                if (ImGui::Checkbox(string_pool().c_str(content.name), &content.enabled)) {
                     // If the user interacts with it, it's no longer "new"
                     content.is_new = false;
+                    engine.touch_active_lists();
                 }
                 if (ImGui::IsItemFocused()) { p_state->focused_content_idx = i; }
 
@@ -331,11 +501,13 @@ void ModManagerScene::render() {
             if (p_state->focused_content_idx != -1) {
                 if (ImGui::IsKeyPressed(ImGuiKey_GamepadL1, false) && p_state->focused_content_idx > 0) {
                     std::swap(mod_manager.active_content_files[p_state->focused_content_idx], mod_manager.active_content_files[p_state->focused_content_idx - 1]);
+                    engine.touch_active_lists();
                     p_state->focused_content_idx--;
                     p_state->focus_request_content = true;
                 }
                 if (ImGui::IsKeyPressed(ImGuiKey_GamepadR1, false) && p_state->focused_content_idx < mod_manager.active_content_files.size() - 1) {
                     std::swap(mod_manager.active_content_files[p_state->focused_content_idx], mod_manager.active_content_files[p_state->focused_content_idx + 1]);
+                    engine.touch_active_lists();
                     p_state->focused_content_idx++;
                     p_state->focus_request_content = true;
                 }
@@ -352,13 +524,21 @@ void ModManagerScene::render() {
                 ImGui::SameLine();
                 if (ImGui::Button("Sort Data")) {
                     engine.run_active_sorter(ScriptRegistration::SORT_DATA);
-                    p_state->needs_refresh = true;
                 }
             }
 
             ImGui::Separator();
             ImGui::BeginChild("DataList", ImVec2(0, -50), true);
             
+            // Labels only change with the mods or the list itself.
+            if (!p_state->labels_valid || p_state->data_path_labels.size() != mod_manager.active_data_paths.size()) {
+                p_state->data_path_labels.clear();
+                for (const auto& path : mod_manager.active_data_paths) {
+                    p_state->data_path_labels.push_back(get_display_path(path, mod_manager, ctx));
+                }
+                p_state->labels_valid = true;
+            }
+
             p_state->focused_data_idx = -1; // Default to no focus
             for (size_t i = 0; i < mod_manager.active_data_paths.size(); ++i) {
                 if (p_state->focus_request_data && p_state->focused_data_idx == (int)i) {
@@ -366,8 +546,7 @@ void ModManagerScene::render() {
                     p_state->focus_request_data = false;
                 }
                 
-                // --- THIS IS THE FIX ---
-                std::string label = get_display_path(mod_manager.active_data_paths[i], mod_manager, ctx);
+                const std::string& label = p_state->data_path_labels[i];
 
                 if (ImGui::Selectable(label.c_str(), p_state->focused_data_idx == (int)i)) { p_state->focused_data_idx = i; }
                 if (ImGui::IsItemFocused()) { p_state->focused_data_idx = i; }
@@ -377,11 +556,13 @@ void ModManagerScene::render() {
             if (p_state->focused_data_idx != -1) {
                 if (ImGui::IsKeyPressed(ImGuiKey_GamepadL1, false) && p_state->focused_data_idx > 0) {
                     std::swap(mod_manager.active_data_paths[p_state->focused_data_idx], mod_manager.active_data_paths[p_state->focused_data_idx - 1]);
+                    engine.touch_active_lists();
                     p_state->focused_data_idx--;
                     p_state->focus_request_data = true;
                 }
                 if (ImGui::IsKeyPressed(ImGuiKey_GamepadR1, false) && p_state->focused_data_idx < mod_manager.active_data_paths.size() - 1) {
                     std::swap(mod_manager.active_data_paths[p_state->focused_data_idx], mod_manager.active_data_paths[p_state->focused_data_idx + 1]);
+                    engine.touch_active_lists();
                     p_state->focused_data_idx++;
                     p_state->focus_request_data = true;
                 }
@@ -393,7 +574,216 @@ void ModManagerScene::render() {
         // --- TAB 4: VALIDATION ---
         if (ImGui::BeginTabItem("Validation")) {
 
-            ImGui::Text("Validation report coming soon!");
+            // --- Record conflicts between the enabled plugins ---
+            if (ImGui::Button("Check Conflicts")) {
+                p_state->pending_conflict_check = true; // started from update()
+            }
+            const ConflictReport& report = engine.get_conflict_report();
+            if (engine.get_generations().conflicts == 0) {
+                ImGui::SameLine();
+                ImGui::TextDisabled("Lists every record that more than one enabled plugin defines.");
+            } else {
+                ImGui::SameLine();
+                if (ImGui::Checkbox("Show identical copies", &p_state->show_identical_conflicts)) {
+                    p_state->conflict_rows_valid = false;
+                }
+                if (!p_state->conflict_rows_valid) {
+                    p_state->conflict_rows.clear();
+                    p_state->identical_conflicts = 0;
+                    for (uint32_t i = 0; i < report.conflicts.size(); ++i) {
+                        if (report.conflicts[i].identical) p_state->identical_conflicts++;
+                        if (!report.conflicts[i].identical || p_state->show_identical_conflicts) p_state->conflict_rows.push_back(i);
+                    }
+                    p_state->conflict_rows_valid = true;
+                }
+
+                ImGui::Text("%zu records in %zu plugins: %zu contested, %zu of them identical copies (%zu plugins read, %.1f ms)",
+                            report.records, report.plugins.size(), report.conflicts.size(), p_state->identical_conflicts,
+                            report.plugins_read, report.build_ms);
+                if (engine.get_conflict_report_lists() != engine.get_generations().active_lists) {
+                    ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "The load order has changed since this check.");
+                }
+                if (!report.unreadable.empty()) {
+                    std::string names;
+                    for (StringId name : report.unreadable) names += (names.empty() ? "" : ", ") + interned(name);
+                    ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "Not checked (missing or unreadable): %s", names.c_str());
+                }
+
+                if (ImGui::BeginTable("Conflicts", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY,
+                                      ImVec2(0, 240))) {
+                    ImGui::TableSetupScrollFreeze(0, 1);
+                    ImGui::TableSetupColumn("Type");
+                    ImGui::TableSetupColumn("ID");
+                    ImGui::TableSetupColumn("Winner");
+                    ImGui::TableSetupColumn("Overrides");
+                    ImGui::TableHeadersRow();
+                    ImGuiListClipper clipper;
+                    clipper.Begin(static_cast<int>(p_state->conflict_rows.size()));
+                    while (clipper.Step()) {
+                        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                            const RecordConflict& conflict = report.conflicts[p_state->conflict_rows[row]];
+                            std::string losers;
+                            for (size_t i = 0; i + 1 < conflict.plugins.size(); ++i) {
+                                losers += (losers.empty() ? "" : ", ") + interned(report.plugins[conflict.plugins[i]]);
+                            }
+                            ImGui::TableNextRow();
+                            ImGui::TableNextColumn(); ImGui::TextUnformatted(record_type_name(conflict.type).c_str());
+                            ImGui::TableNextColumn(); ImGui::TextUnformatted(conflict.id.c_str());
+                            ImGui::TableNextColumn(); ImGui::TextUnformatted(string_pool().c_str(report.plugins[conflict.plugins.back()]));
+                            ImGui::TableNextColumn();
+                            if (conflict.identical) ImGui::TextDisabled("%s", losers.c_str());
+                            else ImGui::TextUnformatted(losers.c_str());
+                        }
+                    }
+                    ImGui::EndTable();
+                }
+            }
+
+            // --- Dirty edits: ITMs and deleted master records/references ---
+            ImGui::Separator();
+            if (ImGui::Button("Find Dirty Edits")) {
+                p_state->pending_dirty_check = true; // started from update()
+            }
+            const DirtyReport& dirty = engine.get_dirty_report();
+            if (engine.get_generations().dirty == 0) {
+                ImGui::SameLine();
+                ImGui::TextDisabled("Lists records a plugin copies unchanged from its masters, or deletes from them.");
+            } else {
+                size_t dirty_plugins = 0, identical = 0, deleted_records = 0, deleted_refs = 0;
+                if (!p_state->dirty_rows_valid) p_state->dirty_rows.clear();
+                for (uint32_t p = 0; p < dirty.plugins.size(); ++p) {
+                    const PluginDirtyReport& plugin = *dirty.plugins[p];
+                    if (plugin.is_dirty()) dirty_plugins++;
+                    identical += plugin.identical;
+                    deleted_records += plugin.deleted_records;
+                    deleted_refs += plugin.deleted_refs;
+                    if (p_state->dirty_rows_valid) continue;
+                    for (uint32_t e = 0; e < plugin.edits.size(); ++e) p_state->dirty_rows.emplace_back(p, e);
+                }
+                p_state->dirty_rows_valid = true;
+
+                ImGui::SameLine();
+                ImGui::BeginDisabled(identical == 0);
+                if (ImGui::Button("Clean ITMs")) {
+                    p_state->pending_clean = true; // started from update()
+                }
+                ImGui::EndDisabled();
+                ImGui::SameLine();
+                if (ImGui::Button("Restore Originals")) {
+                    p_state->pending_restore = true;
+                }
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("Cleaned copies go to mod_data/%s; the originals are never modified.",
+                                      engine.get_cleaned_plugins_dir().filename().string().c_str());
+                }
+
+                ImGui::Text("%zu of %zu plugins dirty: %zu identical to master, %zu deleted records, %zu deleted references "
+                            "(%zu unchanged since last check, %.1f ms)",
+                            dirty_plugins, dirty.plugins.size(), identical, deleted_records, deleted_refs, dirty.reused,
+                            dirty.check_ms);
+                if (engine.get_dirty_report_lists() != engine.get_generations().active_lists) {
+                    ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "The load order has changed since this check.");
+                }
+                if (!dirty.unreadable.empty()) {
+                    std::string names;
+                    for (StringId name : dirty.unreadable) names += (names.empty() ? "" : ", ") + interned(name);
+                    ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "Not checked (missing or unreadable): %s", names.c_str());
+                }
+                for (const auto& plugin : dirty.plugins) {
+                    if (plugin->missing_masters.empty()) continue;
+                    std::string names;
+                    for (StringId name : plugin->missing_masters) names += (names.empty() ? "" : ", ") + interned(name);
+                    ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "%s: masters not found: %s",
+                                       string_pool().c_str(plugin->plugin), names.c_str());
+                }
+
+                if (ImGui::BeginTable("DirtyEdits", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY,
+                                      ImVec2(0, 240))) {
+                    ImGui::TableSetupScrollFreeze(0, 1);
+                    ImGui::TableSetupColumn("Plugin");
+                    ImGui::TableSetupColumn("Problem");
+                    ImGui::TableSetupColumn("Record");
+                    ImGui::TableSetupColumn("Master");
+                    ImGui::TableHeadersRow();
+                    ImGuiListClipper clipper;
+                    clipper.Begin(static_cast<int>(p_state->dirty_rows.size()));
+                    while (clipper.Step()) {
+                        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                            const PluginDirtyReport& plugin = *dirty.plugins[p_state->dirty_rows[row].first];
+                            const DirtyEdit& edit = plugin.edits[p_state->dirty_rows[row].second];
+                            const char* problem = edit.kind == DirtyEdit::IDENTICAL_TO_MASTER ? "Identical to master"
+                                                  : edit.kind == DirtyEdit::DELETED_RECORD   ? "Deleted record"
+                                                                                              : "Deleted reference";
+                            std::string record = record_type_name(edit.type) + " " + edit.id;
+                            if (edit.kind == DirtyEdit::DELETED_REFERENCE) {
+                                record += ": " + edit.object + " #" + std::to_string(edit.refnum);
+                            }
+                            ImGui::TableNextRow();
+                            ImGui::TableNextColumn(); ImGui::TextUnformatted(string_pool().c_str(plugin.plugin));
+                            ImGui::TableNextColumn(); ImGui::TextUnformatted(problem);
+                            ImGui::TableNextColumn(); ImGui::TextUnformatted(record.c_str());
+                            ImGui::TableNextColumn(); ImGui::TextUnformatted(string_pool().c_str(edit.master));
+                        }
+                    }
+                    ImGui::EndTable();
+                }
+            }
+
+            ImGui::Separator();
+            if (ImGui::Button("Rebuild VFS Index")) {
+                p_state->pending_vfs_rebuild = true; // started from update()
+            }
+            const VfsMetrics& vfs = engine.get_vfs_index_metrics();
+            if (vfs.sources > 0) {
+                ImGui::Text("VFS: %zu files, %zu overridden, %zu data paths", vfs.files, vfs.shadowed, vfs.sources);
+                ImGui::Text("Last update: %.1f ms (%zu paths walked), ~%.1f MiB",
+                            vfs.last_sync_ms, vfs.sources_scanned, vfs.memory_bytes / (1024.0 * 1024.0));
+            }
+            StatCache& stat_cache = StatCache::instance();
+            ImGui::Text("Stat cache: %llu hits, %llu misses; render frames with syscalls: %llu (%llu syscalls)",
+                        (unsigned long long)stat_cache.hits(), (unsigned long long)stat_cache.misses(),
+                        (unsigned long long)m_state_machine.get_render_syscall_frames(),
+                        (unsigned long long)m_state_machine.get_render_syscalls());
+
+            // --- Per-mod scan cost, slowest first ---
+            ImGui::Separator();
+            ImGui::Text("Mod Scan Telemetry");
+            std::vector<const ModScanStats*> scans;
+            for (const auto& st : engine.get_scan_stats()) scans.push_back(&st);
+            std::sort(scans.begin(), scans.end(),
+                      [](const ModScanStats* a, const ModScanStats* b) { return a->wall_ms > b->wall_ms; });
+            if (ImGui::BeginTable("ScanStats", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY,
+                                  ImVec2(0, -50))) {
+                ImGui::TableSetupScrollFreeze(0, 1);
+                ImGui::TableSetupColumn("Mod");
+                ImGui::TableSetupColumn("Time (ms)");
+                ImGui::TableSetupColumn("Dirs");
+                ImGui::TableSetupColumn("Entries");
+                ImGui::TableSetupColumn("Stats");
+                ImGui::TableSetupColumn("Notes");
+                ImGui::TableHeadersRow();
+                for (const ModScanStats* st : scans) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::TextUnformatted(st->root.filename().string().c_str());
+                    if (st->cached) {
+                        ImGui::TableNextColumn(); ImGui::TextDisabled("cached");
+                        ImGui::TableNextColumn(); ImGui::TableNextColumn(); ImGui::TableNextColumn();
+                        ImGui::TableNextColumn();
+                        continue;
+                    }
+                    ImGui::TableNextColumn(); ImGui::Text("%.1f", st->wall_ms);
+                    ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)st->dirs_read);
+                    ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)st->entries_read);
+                    ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)st->stats);
+                    ImGui::TableNextColumn();
+                    if (st->truncated) ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "budget hit");
+                    if (st->cycles) {
+                        if (st->truncated) ImGui::SameLine();
+                        ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "%u loops", st->cycles);
+                    }
+                }
+                ImGui::EndTable();
+            }
 
             ImGui::EndTabItem();
         }
@@ -401,8 +791,9 @@ void ModManagerScene::render() {
         ImGui::EndTabBar();
     }
 
+    // The toggles above already patched the active lists.
     if (state_changed) {
-        mod_manager.update_active_lists();
+        engine.touch_active_lists();
     }
 
     if (ImGui::Button("Save and Exit", ImVec2(150, 40))) {
@@ -410,12 +801,12 @@ void ModManagerScene::render() {
         const auto& data = mod_manager.active_data_paths;
         const auto& content = mod_manager.active_content_files;
         
-        bool data_ok = !data.empty() && fs::exists(data.front() / "Morrowind.esm");
+        bool data_ok = !data.empty() && StatCache::instance().exists(data.front() / "Morrowind.esm");
         // Check for presence, order, AND enabled status
         bool content_ok = content.size() >= 3 &&
-                          content[0].name == "Morrowind.esm" && content[0].enabled &&
-                          content[1].name == "Tribunal.esm" && content[1].enabled &&
-                          content[2].name == "Bloodmoon.esm" && content[2].enabled;
+                          content[0].name == intern("Morrowind.esm") && content[0].enabled &&
+                          content[1].name == intern("Tribunal.esm") && content[1].enabled &&
+                          content[2].name == intern("Bloodmoon.esm") && content[2].enabled;
 
         if (data_ok && content_ok) {
             save_and_exit();
@@ -435,6 +826,29 @@ void ModManagerScene::render() {
         p_state->show_save_warning = false; // Reset trigger
     }
 
+    if (p_state->show_reload_prompt) {
+        ImGui::OpenPopup("openmw.cfg Changed");
+        p_state->show_reload_prompt = false;
+    }
+
+    if (ImGui::BeginPopupModal("openmw.cfg Changed", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::Text("openmw.cfg was changed by another program, but your\n"
+                    "load order here has unsaved changes.\n\n"
+                    "Reloading discards them. Keeping them means saving\n"
+                    "will overwrite the other program's changes.\n");
+        ImGui::Separator();
+
+        if (ImGui::Button("Reload", ImVec2(150, 0))) {
+            p_state->pending_config_reload = true; // started from update()
+            ImGui::CloseCurrentPopup();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Keep My Changes", ImVec2(150, 0))) {
+            ImGui::CloseCurrentPopup();
+        }
+        ImGui::EndPopup();
+    }
+
     if (ImGui::BeginPopupModal("Save Warning", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
         ImGui::Text("Your load order has critical issues!\n\n"
                     "- Morrowind.esm must be in the first data path.\n"
@@ -7,9 +7,12 @@ public:
     ~ModManagerScene();
     void on_enter() override;
     void handle_event(SDL_Event& e) override;
+    void update() override;
     void render() override;
 
 private:
+    void sync_with_engine();
+    void render_operation_progress();
     void fix_load_order_and_save();
     void save_and_exit();
     
@@ -6,7 +6,6 @@
 #include "MainMenuScene.h"
 #include "AlertScene.h"
 #include "imgui.h"
-#include <thread>
 
 PreLaunchScene::PreLaunchScene(StateMachine& machine, std::vector<ScriptDefinition*> scripts)
     : Scene(machine), m_scripts(std::move(scripts)) {}
@@ -86,8 +85,9 @@ void PreLaunchScene::handle_event(SDL_Event& e) {
                 m_state = State::AWAITING_UI_FINISH;
 
             } else if (auto headless_runner = std::dynamic_pointer_cast<HeadlessScriptRunner>(m_current_runner)) {
-                // Capture the shared_ptr to keep it alive for the thread
-                std::thread([headless_runner](){ headless_runner->run(); }).detach();
+                // Capture the shared_ptr to keep it alive for the task
+                m_state_machine.get_engine().get_scheduler().submit([headless_runner]() { headless_runner->run(); },
+                                                                    TaskScheduler::BULK);
                 m_state = State::RUNNING_HEADLESS;
             }
         }
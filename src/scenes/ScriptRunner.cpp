@@ -60,6 +60,8 @@ void ScriptRunner::run(const std::map<std::string, std::string>& extra_vars, boo
     }
 
     if (m_pid == 0) { // Child process
+        // Its own process group, so kill(-pid) also reaches whatever it starts.
+        setpgid(0, 0);
         close(pipe_fd[0]);
         dup2(pipe_fd[1], STDOUT_FILENO);
         dup2(pipe_fd[1], STDERR_FILENO);
@@ -71,6 +73,7 @@ void ScriptRunner::run(const std::map<std::string, std::string>& extra_vars, boo
     }
     
     // Parent process
+    setpgid(m_pid, 0); // as in the child; whichever runs first wins the race
     close(pipe_fd[1]);
     
     engine.add_running_script(this); // Register with engine for cleanup
@@ -196,8 +199,9 @@ void ScriptRunner::on_line_received(const std::string& line) {
 void ScriptRunner::on_progress_update() {}
 void ScriptRunner::on_alert(const AlertInfo& alert) {}
 void ScriptRunner::on_finish(int return_code) {
-    m_is_finished = true;
+    // Unregister first, so kill_running_scripts() never races the flag.
     m_state_machine.get_engine().remove_running_script(this);
+    m_is_finished = true;
     if (!m_cancel_file_path.empty() && fs::exists(m_cancel_file_path)) {
         fs::remove(m_cancel_file_path);
     }
@@ -219,36 +223,20 @@ void HeadlessScriptRunner::on_alert(const AlertInfo& alert) {
 UIScriptRunner::UIScriptRunner(StateMachine& machine, ScriptDefinition& script)
     : ScriptRunner(machine, script) {}
 
-// NEW: Link the scene to the runner
-void UIScriptRunner::set_scene_ptr(ScriptRunnerScene* scene_ptr) {
-    m_scene_ptr = scene_ptr;
-}
-
-
 void UIScriptRunner::on_line_received(const std::string& line) {
     ScriptRunner::on_line_received(line);
-
-    if (m_scene_ptr) {
-        std::lock_guard<std::mutex> lock(m_scene_ptr->m_log_mutex);
-        m_scene_ptr->m_log_lines.push_back(line);
-    }
+    m_line_queue.push(line);
 }
 
 void UIScriptRunner::on_progress_update() {
-    if (m_scene_ptr) {
-        std::lock_guard<std::mutex> lock(m_scene_ptr->m_progress_mutex);
-        m_scene_ptr->m_progress = m_progress;
-    }
+    m_progress_queue.push(m_progress);
 }
 
 void UIScriptRunner::on_alert(const AlertInfo& alert) {
-    if (m_scene_ptr) {
-        m_scene_ptr->m_alert = alert; // Just copy the whole struct
-        m_scene_ptr->m_show_alert = true;
-    }
+    m_alert_queue.push(alert);
 }
 
 void UIScriptRunner::on_finish(int return_code) {
     ScriptRunner::on_finish(return_code); // Call base implementation
-    if (m_scene_ptr) m_scene_ptr->m_is_finished = true;
+    m_ui_finished.store(true, std::memory_order_release);
 }
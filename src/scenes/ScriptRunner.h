@@ -7,6 +7,7 @@
 #include <chrono>
 #include "../mod/ScriptManager.h" // For ScriptDefinition
 #include "../core/ModEngine.h"
+#include "../utils/SpscQueue.h"
 
 // Forward declare StateMachine to break circular dependency
 class StateMachine;
@@ -96,18 +97,20 @@ class UIScriptRunner : public ScriptRunner {
 public:
     UIScriptRunner(StateMachine& machine, ScriptDefinition& script);
 
-    void set_scene_ptr(ScriptRunnerScene* scene_ptr);
-
     void request_cancellation() { ScriptRunner::request_cancellation(); }
 
 private:
     friend class ScriptRunnerScene;
 
-    // Overrides to update the UI scene
+    // Overrides that queue output for the UI scene, which drains it each frame
     void on_line_received(const std::string& line) override;
     void on_progress_update() override;
     void on_alert(const AlertInfo& alert) override;
     void on_finish(int return_code) override;
-    
-    ScriptRunnerScene* m_scene_ptr = nullptr;
+
+    // Runner task -> scene. The runner owns them, so they outlive whichever side finishes first.
+    SpscQueue<std::string> m_line_queue;
+    SpscQueue<ProgressState> m_progress_queue;
+    SpscQueue<AlertInfo> m_alert_queue;
+    std::atomic<bool> m_ui_finished{false}; // set after the last push
 };
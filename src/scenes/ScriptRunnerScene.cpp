@@ -4,7 +4,6 @@
 #include "../core/StateMachine.h"
 #include "../AppContext.h"
 #include "imgui.h"
-#include <thread>
 #include <iostream>
 #include <boost/filesystem/path.hpp>
 #include <fstream>
@@ -16,13 +15,26 @@ ScriptRunnerScene::ScriptRunnerScene(StateMachine& machine, std::shared_ptr<UISc
     : Scene(machine), m_owner(std::move(owner)), m_script(script), m_use_temp_cfg(use_temp_cfg) {}
 
 void ScriptRunnerScene::on_enter() {
-    m_owner->set_scene_ptr(this);
-    std::thread([owner = m_owner, use_temp_cfg = m_use_temp_cfg]() {
+    // The runner queues its output for update() to drain; the shared_ptr keeps it alive for the task.
+    // The task blocks until the script exits; on quit, ~ModEngine kills it so the scheduler can join.
+    m_state_machine.get_engine().get_scheduler().submit([owner = m_owner, use_temp_cfg = m_use_temp_cfg]() {
         owner->run({}, use_temp_cfg); // Use the member flag
-    }).detach();
+    }, TaskScheduler::BULK);
 }
 
 
+// Once per frame: take whatever the runner produced since the last one.
+void ScriptRunnerScene::update() {
+    // Read the flag first: anything pushed before it was set is drained below.
+    bool finished = m_owner->m_ui_finished.load(std::memory_order_acquire);
+    m_owner->m_line_queue.drain([&](std::string&& line) { m_log_lines.push_back(std::move(line)); });
+    m_owner->m_progress_queue.drain([&](ProgressState&& progress) { m_progress = std::move(progress); });
+    m_owner->m_alert_queue.drain([&](AlertInfo&& alert) {
+        if (m_alerts.empty()) m_show_alert = true;
+        m_alerts.push_back(std::move(alert));
+    });
+    if (finished) m_is_finished = true;
+}
 
 void ScriptRunnerScene::render() {
     ImGui::SetNextWindowPos(ImVec2(0, 0));
@@ -35,7 +47,6 @@ void ScriptRunnerScene::render() {
     ImGui::BeginChild("MainContent", ImVec2(0, -bottom_bar_height), false, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
 
     if (m_script.has_progress) {
-        std::lock_guard<std::mutex> lock(m_progress_mutex);
         ImGui::Text("%s", m_progress.name.c_str());
         float progress_fraction = (m_progress.total > 0) ? (float)m_progress.step / m_progress.total : 0.0f;
         ImGui::ProgressBar(progress_fraction, ImVec2(-1, 0));
@@ -45,15 +56,12 @@ void ScriptRunnerScene::render() {
 
     if (m_script.has_output) {
         ImGui::BeginChild("LogPanel", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar);
-        {
-            std::lock_guard<std::mutex> lock(m_log_mutex);
-            for (const auto& line : m_log_lines) {
-                // Use TextUnformatted for raw output from scripts
-                ImGui::TextUnformatted(line.c_str());
-            }
-            if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
-                ImGui::SetScrollHereY(1.0f);
-            }
+        for (const auto& line : m_log_lines) {
+            // Use TextUnformatted for raw output from scripts
+            ImGui::TextUnformatted(line.c_str());
+        }
+        if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
+            ImGui::SetScrollHereY(1.0f);
         }
         ImGui::EndChild();
     }
@@ -98,21 +106,31 @@ void ScriptRunnerScene::render() {
     }
     
     // --- Alert Modal ---
-    const std::string popup_id = m_alert.title + "##AlertPopup";
-    if (m_show_alert) {
-        ImGui::OpenPopup(popup_id.c_str());
-        m_show_alert = false; // Reset trigger
-    }
+    // Alerts queue up; each OK shows the next one.
+    if (!m_alerts.empty()) {
+        const AlertInfo& alert = m_alerts.front();
+        const std::string popup_id = alert.title + "##AlertPopup";
+        if (m_show_alert) {
+            ImGui::OpenPopup(popup_id.c_str());
+            m_show_alert = false; // Reset trigger
+        }
 
-    // Use a unique ID for the popup in case of multiple alerts
-    if (ImGui::BeginPopupModal(popup_id.c_str(), NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
-        ImGui::TextWrapped("%s", m_alert.message.c_str());
-        ImGui::Separator();
-        if (ImGui::Button("OK", ImVec2(120, 0))) { 
-            ImGui::CloseCurrentPopup(); 
+        // Use a unique ID for the popup in case of multiple alerts
+        if (ImGui::BeginPopupModal(popup_id.c_str(), NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
+            ImGui::TextWrapped("%s", alert.message.c_str());
+            ImGui::Separator();
+            bool dismissed = false;
+            if (ImGui::Button("OK", ImVec2(120, 0))) {
+                ImGui::CloseCurrentPopup();
+                dismissed = true;
+            }
+            ImGui::SetItemDefaultFocus();
+            ImGui::EndPopup();
+            if (dismissed) {
+                m_alerts.pop_front();
+                m_show_alert = !m_alerts.empty();
+            }
         }
-        ImGui::SetItemDefaultFocus();
-        ImGui::EndPopup();
     }
 
     ImGui::End();
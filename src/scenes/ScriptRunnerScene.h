@@ -1,9 +1,9 @@
 #pragma once
 #include "Scene.h"
 #include "ScriptRunner.h"
-#include <mutex>
+#include <deque>
 
-// The scene is now a friend of the runner that controls it
+// The runner makes the scene a friend so it can drain its output queues
 class UIScriptRunner;
 
 class ScriptRunnerScene : public Scene {
@@ -12,20 +12,17 @@ public:
 
     void on_enter() override;
 
+    void update() override;
     void render() override;
 
 private:
-    friend class UIScriptRunner; // Allow owner to access private members
-
     std::shared_ptr<UIScriptRunner> m_owner; // Scene OWNS the runner
     ScriptDefinition& m_script;
 
-    std::mutex m_log_mutex;
+    // UI-thread copies, filled from the runner's queues in update().
     std::vector<std::string> m_log_lines;
-
-    std::mutex m_progress_mutex;
     ProgressState m_progress;
-    AlertInfo m_alert;
+    std::deque<AlertInfo> m_alerts; // front is the one on screen
 
     bool m_use_temp_cfg; // Add member
     bool m_is_finished = false;
@@ -125,12 +125,21 @@ void UtilitiesScene::render() {
 
     // Content Sorter Dropdown
     auto content_sorters = script_manager.get_scripts_by_registration(ScriptRegistration::SORT_CONTENT);
+    const char* native_label = "Built-in (by masters)";
     const char* current_cs_label = "None";
-    if (!script_manager.get_active_content_sorter_path().empty()) {
+    if (script_manager.is_native_content_sorter_active()) {
+        current_cs_label = native_label;
+    } else if (!script_manager.get_active_content_sorter_path().empty()) {
         auto* s = script_manager.get_script_by_path(script_manager.get_active_content_sorter_path());
         if (s) current_cs_label = s->title.c_str();
     }
     if (ImGui::BeginCombo("Content Sorter", current_cs_label)) {
+        bool native_selected = script_manager.is_native_content_sorter_active();
+        if (ImGui::Selectable(native_label, native_selected)) {
+            script_manager.set_active_content_sorter_path(ScriptManager::native_content_sorter());
+            script_manager.save_options(options_path);
+        }
+        if (native_selected) ImGui::SetItemDefaultFocus();
         for (auto* script : content_sorters) {
             bool is_selected = script_manager.get_active_content_sorter_path() == script->script_path;
             if (ImGui::Selectable(script->title.c_str(), is_selected)) {
@@ -0,0 +1,48 @@
+#include "CacheFile.h"
+#include "Logger.h"
+#include <algorithm>
+#include <fstream>
+
+CacheOpen open_cache_file(std::ifstream& in, const fs::path& file, const char* magic, uint32_t version,
+                          const char* what) {
+    in.open(file.string(), std::ios::binary);
+    if (!in.is_open()) return CacheOpen::MISSING;
+
+    char found[CACHE_MAGIC_SIZE] = {};
+    in.read(found, sizeof(found));
+    CacheReader r{in};
+    if (!r.ok() || !std::equal(found, found + CACHE_MAGIC_SIZE, magic) || r.u32() != version || !r.ok()) {
+        LOG_INFO("Ignoring incompatible ", what, " at ", file.string());
+        return CacheOpen::INCOMPATIBLE;
+    }
+    return CacheOpen::OK;
+}
+
+bool save_cache_file(const fs::path& file, const char* magic, uint32_t version, const char* what,
+                     const std::function<void(CacheWriter&)>& body) {
+    fs::path temp_file = file;
+    temp_file += ".tmp";
+    {
+        std::ofstream out(temp_file.string(), std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            LOG_WARN("Could not write ", what, " to ", temp_file.string());
+            return false;
+        }
+        out.write(magic, CACHE_MAGIC_SIZE);
+        CacheWriter w{out};
+        w.u32(version);
+        body(w);
+        if (!out) {
+            LOG_WARN("Could not write ", what, " to ", temp_file.string());
+            return false;
+        }
+    }
+
+    boost::system::error_code ec;
+    fs::rename(temp_file, file, ec);
+    if (ec) {
+        LOG_WARN("Could not replace ", what, " ", file.string(), ": ", ec.message());
+        return false;
+    }
+    return true;
+}
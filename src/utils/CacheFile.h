@@ -0,0 +1,83 @@
+#pragma once
+#include "DirListing.h"
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+// Plain little-endian-as-stored binary fields, shared by the on-disk caches
+// (scan index, plugin headers, plugin records). Each cache writes its own
+// entries with these.
+struct CacheWriter {
+    std::ostream& out;
+
+    void u8(uint8_t v) { out.put(static_cast<char>(v)); }
+    void u32(uint32_t v) { bytes(&v, sizeof(v)); }
+    void u64(uint64_t v) { bytes(&v, sizeof(v)); }
+    void bytes(const void* data, size_t n) { out.write(static_cast<const char*>(data), n); }
+    void str(const std::string& s) {
+        u32(static_cast<uint32_t>(s.size()));
+        bytes(s.data(), s.size());
+    }
+    void stamp(const FileStamp& s) {
+        u64(s.size);
+        u64(static_cast<uint64_t>(s.mtime_ns));
+    }
+};
+
+struct CacheReader {
+    std::istream& in;
+    // Default bound on counts and string lengths; anything past it is a
+    // truncated or corrupt file, not a reason to allocate gigabytes.
+    static const uint32_t MAX_COUNT = 1u << 24;
+
+    bool ok() const { return static_cast<bool>(in); }
+    void fail() { in.setstate(std::ios::failbit); }
+
+    uint8_t u8() { char c = 0; in.get(c); return static_cast<uint8_t>(c); }
+    uint32_t u32() { uint32_t v = 0; bytes(&v, sizeof(v)); return v; }
+    uint64_t u64() { uint64_t v = 0; bytes(&v, sizeof(v)); return v; }
+    void bytes(void* data, size_t n) { in.read(static_cast<char*>(data), n); }
+    uint32_t count(uint32_t max = MAX_COUNT) {
+        uint32_t n = u32();
+        if (n > max) fail();
+        return ok() ? n : 0;
+    }
+    std::string str(uint32_t max = MAX_COUNT) {
+        uint32_t n = count(max);
+        std::string s(n, '\0');
+        if (n) bytes(&s[0], n);
+        return s;
+    }
+    FileStamp stamp() {
+        FileStamp s;
+        s.size = u64();
+        s.mtime_ns = static_cast<int64_t>(u64());
+        return s;
+    }
+};
+
+// Every cache file starts with 8 magic bytes and a version. Bump the version
+// whenever a cache's layout, or the code producing its contents, changes, so
+// files from older builds are discarded instead of misread.
+const size_t CACHE_MAGIC_SIZE = 8;
+
+enum class CacheOpen {
+    MISSING,      // no file yet
+    INCOMPATIBLE, // another magic or version (logged); rebuild it
+    OK,           // positioned at the first byte after the header
+};
+
+// Opens `file` into `in` and checks its header. `what` names the cache in logs.
+CacheOpen open_cache_file(std::ifstream& in, const fs::path& file, const char* magic, uint32_t version,
+                          const char* what);
+
+// Writes the header, then whatever `body` writes, to a sibling temp file and
+// renames it over `file`, so a crash never leaves a torn cache. Logs and
+// returns false on failure.
+bool save_cache_file(const fs::path& file, const char* magic, uint32_t version, const char* what,
+                     const std::function<void(CacheWriter&)>& body);
@@ -0,0 +1,176 @@
+#include "DirListing.h"
+#include "DirectorySource.h"
+#include <cstddef>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+std::atomic<uint64_t> g_opens{0};
+std::atomic<uint64_t> g_getdents{0};
+std::atomic<uint64_t> g_stats{0};
+thread_local FsCounters t_counters;
+
+// Kernel layout for getdents64; glibc does not export it.
+struct linux_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+// Big enough that typical mod folders come back in one or two calls.
+const size_t GETDENTS_BUFFER_SIZE = 64 * 1024;
+
+DirEntry::Type type_from_mode(mode_t mode) {
+    if (S_ISDIR(mode)) return DirEntry::DIRECTORY;
+    if (S_ISREG(mode)) return DirEntry::FILE;
+    return DirEntry::OTHER;
+}
+
+void fill_dir_stamp(const struct stat& st, DirStamp& out) {
+    out.dev = static_cast<uint64_t>(st.st_dev);
+    out.ino = static_cast<uint64_t>(st.st_ino);
+    out.mtime_sec = static_cast<int64_t>(st.st_mtim.tv_sec);
+    out.mtime_nsec = static_cast<int64_t>(st.st_mtim.tv_nsec);
+}
+
+} // namespace
+
+const DirEntry* DirListing::find(const std::string& name) const {
+    for (const auto& entry : entries) {
+        if (entry.name == name) return &entry;
+    }
+    return nullptr;
+}
+
+bool read_dir_stamp(const fs::path& dir_path, DirStamp& out) {
+    struct stat st;
+    if (!stat_path(dir_path, st) || !S_ISDIR(st.st_mode)) return false;
+    fill_dir_stamp(st, out);
+    return true;
+}
+
+FileStamp file_stamp_of(const struct stat& st) {
+    FileStamp stamp;
+    stamp.size = static_cast<uint64_t>(st.st_size);
+    stamp.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    return stamp;
+}
+
+bool read_file_stamp(const fs::path& path, FileStamp& out) {
+    struct stat st;
+    if (!stat_path(path, st) || !S_ISREG(st.st_mode)) return false;
+    out = file_stamp_of(st);
+    return true;
+}
+
+bool read_directory(const fs::path& dir_path, DirListing& out) {
+    out.ok = false;
+    out.entries.clear();
+    out.stamp = DirStamp();
+
+    int fd = ::open(dir_path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    g_opens++;
+    t_counters.opens++;
+    if (fd < 0) return false;
+
+    // Stamp first: an entry added while we read then leaves a newer mtime
+    // than the one recorded, so the listing is never mistaken for current.
+    struct stat dir_st;
+    g_stats++;
+    t_counters.stats++;
+    if (::fstat(fd, &dir_st) == 0) fill_dir_stamp(dir_st, out.stamp);
+
+    std::vector<char> buffer(GETDENTS_BUFFER_SIZE);
+    for (;;) {
+        long bytes = ::syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+        g_getdents++;
+        t_counters.getdents++;
+        if (bytes < 0) {
+            ::close(fd);
+            return false;
+        }
+        if (bytes == 0) break;
+
+        for (long offset = 0; offset < bytes;) {
+            auto* d = reinterpret_cast<linux_dirent64*>(buffer.data() + offset);
+            offset += d->d_reclen;
+
+            const char* name = d->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+
+            DirEntry entry;
+            entry.name = name;
+            entry.ino = d->d_ino;
+            if (d->d_type == DT_DIR) {
+                entry.type = DirEntry::DIRECTORY;
+            } else if (d->d_type == DT_REG) {
+                entry.type = DirEntry::FILE;
+            } else if (d->d_type == DT_LNK || d->d_type == DT_UNKNOWN) {
+                // Follow symlinks like fs::is_directory() does.
+                struct stat st;
+                g_stats++;
+                t_counters.stats++;
+                if (::fstatat(fd, name, &st, 0) == 0) {
+                    entry.type = type_from_mode(st.st_mode);
+                    // Identify what the link points at, for cycle detection.
+                    entry.ino = static_cast<uint64_t>(st.st_ino);
+                    entry.dev = static_cast<uint64_t>(st.st_dev);
+                }
+            }
+            out.entries.push_back(std::move(entry));
+        }
+    }
+
+    ::close(fd);
+    out.ok = true;
+    return true;
+}
+
+bool stat_path(const fs::path& path, struct stat& out) {
+    g_stats++;
+    t_counters.stats++;
+    return ::stat(path.c_str(), &out) == 0;
+}
+
+int open_path_readonly(const fs::path& path) {
+    g_opens++;
+    t_counters.opens++;
+    return ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+FsCounters fs_counters_snapshot() {
+    return {g_opens.load(), g_getdents.load(), g_stats.load()};
+}
+
+FsCounters fs_thread_counters_snapshot() {
+    return t_counters;
+}
+
+DirectoryCache::DirectoryCache(DirectorySource* source)
+    : m_source(source ? source : &RealDirectorySource::instance()) {}
+
+const DirListing& DirectoryCache::list(const fs::path& dir_path) {
+    auto it = m_listings.find(dir_path.string());
+    if (it != m_listings.end()) return it->second;
+
+    DirListing& listing = m_listings[dir_path.string()];
+    if (m_source->list(dir_path, listing)) {
+        m_dirs_read++;
+        m_entries_read += listing.entries.size();
+    }
+    return listing;
+}
+
+std::vector<ListedDir> DirectoryCache::listed_dirs() const {
+    std::vector<ListedDir> dirs;
+    for (const auto& pair : m_listings) {
+        if (pair.second.ok) dirs.push_back(ListedDir{pair.first, pair.second.stamp});
+    }
+    return dirs;
+}
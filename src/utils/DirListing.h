@@ -0,0 +1,115 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/stat.h>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+// One entry of a directory listing. The type comes straight from d_type where
+// the filesystem provides it; symlinks and DT_UNKNOWN are resolved with a stat.
+struct DirEntry {
+    enum Type : uint8_t { FILE, DIRECTORY, OTHER };
+    std::string name;
+    Type type = OTHER;
+    uint64_t ino = 0; // 0 if the source has no inodes
+    uint64_t dev = 0; // only set when the entry was stat()ed (e.g. a symlink); 0 = same as its directory
+};
+
+// Identity + modification stamp of a directory. A directory's mtime changes
+// whenever an entry inside it is created, removed or renamed, which is all the
+// mod parser cares about.
+struct DirStamp {
+    uint64_t dev = 0;
+    uint64_t ino = 0;
+    int64_t mtime_sec = 0;
+    int64_t mtime_nsec = 0;
+
+    bool operator==(const DirStamp& other) const {
+        return dev == other.dev && ino == other.ino &&
+               mtime_sec == other.mtime_sec && mtime_nsec == other.mtime_nsec;
+    }
+    bool operator!=(const DirStamp& other) const { return !(*this == other); }
+};
+
+// Returns false if the path does not exist or is not a directory.
+bool read_dir_stamp(const fs::path& dir_path, DirStamp& out);
+
+// Size and modification time of a regular file. The on-disk caches treat a
+// file whose stamp is unchanged as unchanged.
+struct FileStamp {
+    uint64_t size = 0;
+    int64_t mtime_ns = 0;
+
+    bool operator==(const FileStamp& other) const { return size == other.size && mtime_ns == other.mtime_ns; }
+    bool operator!=(const FileStamp& other) const { return !(*this == other); }
+};
+
+FileStamp file_stamp_of(const struct stat& st);
+// Returns false if the path does not exist or is not a regular file.
+bool read_file_stamp(const fs::path& path, FileStamp& out);
+
+struct DirListing {
+    bool ok = false;                // false if the directory could not be opened
+    std::vector<DirEntry> entries;  // in on-disk order, without "." and ".."
+    DirStamp stamp;                 // taken before the entries were read; zero if the source has none
+
+    const DirEntry* find(const std::string& name) const;
+};
+
+// Reads a whole directory with getdents64 in a single pass.
+bool read_directory(const fs::path& dir_path, DirListing& out);
+
+// stat() that is accounted for in the filesystem counters.
+bool stat_path(const fs::path& path, struct stat& out);
+// open(O_RDONLY) that is accounted for in the filesystem counters. Returns
+// the descriptor, or -1.
+int open_path_readonly(const fs::path& path);
+
+// Process-wide counters of the filesystem syscalls issued by the scanners.
+struct FsCounters {
+    uint64_t opens = 0;
+    uint64_t getdents = 0;
+    uint64_t stats = 0;
+
+    FsCounters operator-(const FsCounters& other) const {
+        return {opens - other.opens, getdents - other.getdents, stats - other.stats};
+    }
+};
+FsCounters fs_counters_snapshot();
+// The same counters, for the calling thread only (for per-mod accounting
+// while scans run in parallel).
+FsCounters fs_thread_counters_snapshot();
+
+class DirectorySource;
+
+// A directory a DirectoryCache listed, with the stamp it had when it was read.
+struct ListedDir {
+    fs::path path;
+    DirStamp stamp;
+};
+
+// Per-scan cache that lists each directory at most once and shares that
+// listing between every classifier that asks about it. Not thread-safe; use
+// one cache per worker. Reads the real filesystem unless given a source.
+class DirectoryCache {
+public:
+    explicit DirectoryCache(DirectorySource* source = nullptr);
+
+    const DirListing& list(const fs::path& dir_path);
+
+    // All directories that were successfully listed through this cache.
+    std::vector<ListedDir> listed_dirs() const;
+    // Totals over every listing actually read (cache hits are free).
+    uint64_t dirs_read() const { return m_dirs_read; }
+    uint64_t entries_read() const { return m_entries_read; }
+
+private:
+    DirectorySource* m_source;
+    std::unordered_map<std::string, DirListing> m_listings;
+    uint64_t m_dirs_read = 0;
+    uint64_t m_entries_read = 0;
+};
@@ -0,0 +1,132 @@
+#include "DirectorySource.h"
+#include "Logger.h"
+#include <cstdio>
+#include <sstream>
+
+// =============================================================================
+// REAL FILESYSTEM
+// =============================================================================
+
+bool RealDirectorySource::list(const fs::path& dir_path, DirListing& out) {
+    return read_directory(dir_path, out);
+}
+
+RealDirectorySource& RealDirectorySource::instance() {
+    static RealDirectorySource source;
+    return source;
+}
+
+// =============================================================================
+// IN-MEMORY TREE
+// =============================================================================
+
+void MemoryDirectorySource::add_entry(const fs::path& path, DirEntry::Type type) {
+    std::string key = path.string();
+    if (key.empty() || !m_nodes.insert(key).second) return;
+
+    if (type == DirEntry::DIRECTORY) {
+        m_dirs[key].ok = true;
+    }
+    fs::path parent = path.parent_path();
+    if (parent.empty() || parent == path) return;
+
+    add_entry(parent, DirEntry::DIRECTORY);
+    DirEntry entry;
+    entry.name = path.filename().string();
+    entry.type = type;
+    m_dirs[parent.string()].entries.push_back(std::move(entry));
+}
+
+void MemoryDirectorySource::add_directory(const fs::path& dir_path) {
+    add_entry(dir_path, DirEntry::DIRECTORY);
+}
+
+void MemoryDirectorySource::add_file(const fs::path& file_path) {
+    add_entry(file_path, DirEntry::FILE);
+}
+
+void MemoryDirectorySource::clear() {
+    m_dirs.clear();
+    m_nodes.clear();
+}
+
+bool MemoryDirectorySource::list(const fs::path& dir_path, DirListing& out) {
+    auto it = m_dirs.find(dir_path.string());
+    if (it == m_dirs.end()) {
+        out.ok = false;
+        out.entries.clear();
+        return false;
+    }
+    out = it->second;
+    return true;
+}
+
+// =============================================================================
+// ARCHIVE LISTING
+// =============================================================================
+
+bool ArchiveListingSource::load_listing(std::istream& listing) {
+    clear();
+    add_directory(m_root);
+
+    // The technical listing is one "Key = Value" block per entry, blank-line
+    // separated, after a "----------" line that ends the archive header.
+    bool in_entries = false;
+    std::string line, path;
+    bool is_dir = false;
+    size_t count = 0;
+    auto flush = [&]() {
+        if (!path.empty()) {
+            for (auto& c : path) if (c == '\\') c = '/';
+            if (is_dir) add_directory(m_root / path);
+            else add_file(m_root / path);
+            ++count;
+        }
+        path.clear();
+        is_dir = false;
+    };
+
+    while (std::getline(listing, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!in_entries) {
+            if (line.compare(0, 10, "----------") == 0) in_entries = true;
+            continue;
+        }
+        if (line.empty()) {
+            flush();
+            continue;
+        }
+        if (line.compare(0, 7, "Path = ") == 0) {
+            flush();
+            path = line.substr(7);
+        } else if (line.compare(0, 9, "Folder = ") == 0) {
+            is_dir = line.size() > 9 && line[9] == '+';
+        } else if (line.compare(0, 13, "Attributes = ") == 0) {
+            // Some formats only mark folders through the attribute string.
+            if (line.size() > 13 && line[13] == 'D') is_dir = true;
+        }
+    }
+    flush();
+    return in_entries;
+}
+
+bool ArchiveListingSource::load(const fs::path& exec_7zz, const fs::path& archive_path) {
+    std::string command = "\"" + exec_7zz.string() + "\" l -slt \"" + archive_path.string() + "\" 2>/dev/null";
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) {
+        LOG_WARN("Could not run 7-Zip to list ", archive_path.string());
+        return false;
+    }
+    std::string output;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0) output.append(buffer, n);
+    int status = pclose(pipe);
+
+    std::istringstream stream(output);
+    if (!load_listing(stream) || status != 0) {
+        LOG_WARN("Could not list archive ", archive_path.string());
+        return false;
+    }
+    return true;
+}
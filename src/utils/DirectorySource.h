@@ -0,0 +1,64 @@
+#pragma once
+#include "DirListing.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+// Where directory listings come from. The mod layout rules only ever ask for
+// listings, so they run unchanged on disk, on a synthetic tree or on the
+// contents of an archive that hasn't been extracted yet.
+class DirectorySource {
+public:
+    virtual ~DirectorySource() = default;
+
+    // Fills `out` with the entries of `dir_path`. Returns false (and leaves
+    // out.ok false) if it doesn't exist or can't be read.
+    virtual bool list(const fs::path& dir_path, DirListing& out) = 0;
+};
+
+// The real filesystem, via read_directory().
+class RealDirectorySource : public DirectorySource {
+public:
+    bool list(const fs::path& dir_path, DirListing& out) override;
+
+    // Shared stateless instance, used when no source is given.
+    static RealDirectorySource& instance();
+};
+
+// A tree held entirely in memory. Parent directories are created implicitly.
+class MemoryDirectorySource : public DirectorySource {
+public:
+    void add_directory(const fs::path& dir_path);
+    void add_file(const fs::path& file_path);
+    void clear();
+
+    size_t node_count() const { return m_nodes.size(); }
+
+    bool list(const fs::path& dir_path, DirListing& out) override;
+
+private:
+    void add_entry(const fs::path& path, DirEntry::Type type);
+
+    std::unordered_map<std::string, DirListing> m_dirs;
+    std::unordered_set<std::string> m_nodes; // every file and directory added, to skip duplicates
+};
+
+// The contents of an archive, as reported by `7zz l -slt`, mounted under
+// `root` (normally the folder it would be extracted to).
+class ArchiveListingSource : public MemoryDirectorySource {
+public:
+    explicit ArchiveListingSource(const fs::path& root) : m_root(root) {}
+
+    // Runs 7-Zip on `archive_path` and loads its listing.
+    bool load(const fs::path& exec_7zz, const fs::path& archive_path);
+    // Loads an already captured `-slt` listing.
+    bool load_listing(std::istream& listing);
+
+    const fs::path& root() const { return m_root; }
+
+private:
+    fs::path m_root;
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 32-bit FNV-1a, for strings and paths going into a HashIndex.
+inline uint32_t fnv1a_32(const char* data, size_t length) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < length; ++i) {
+        h ^= static_cast<uint8_t>(data[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+inline uint32_t fnv1a_32(const std::string& s) { return fnv1a_32(s.data(), s.size()); }
+
+// Linear probing degrades quickly past ~70% full; every open-addressing
+// table here grows before `count` entries would cross that.
+inline bool probe_table_full(size_t count, size_t capacity) { return count * 10 > capacity * 7; }
+
+// Open-addressing index over elements the caller keeps elsewhere (a vector,
+// a chunk list, a record table), each addressed by a dense uint32_t. The
+// table holds only (hash, index) pairs; the caller says what makes two
+// elements equal, so hash collisions are settled against the real keys.
+// Linear probing and no erase: the interning tables it backs only grow.
+template <typename Hash>
+class HashIndex {
+public:
+    static const uint32_t NONE = 0xFFFFFFFFu;
+
+    size_t size() const { return m_size; }
+
+    // The first element under `hash` for which `equal(index)` holds, or NONE.
+    template <typename Equal>
+    uint32_t find(Hash hash, Equal&& equal) const {
+        if (m_slots.empty()) return NONE;
+        size_t mask = m_slots.size() - 1;
+        for (size_t i = static_cast<size_t>(hash) & mask;; i = (i + 1) & mask) {
+            const Slot& slot = m_slots[i];
+            if (slot.index == NONE) return NONE;
+            if (slot.hash == hash && equal(slot.index)) return slot.index;
+        }
+    }
+
+    // Adds `index` under `hash`. The caller has already checked with find()
+    // that no equal element is present.
+    void insert(Hash hash, uint32_t index) {
+        if (probe_table_full(m_size + 1, m_slots.size())) rehash(m_slots.empty() ? MIN_CAPACITY : m_slots.size() * 2);
+        place(Slot{hash, index});
+        ++m_size;
+    }
+
+    // Sizes the table for `count` elements at once, for tables built in one go.
+    void reserve(size_t count) {
+        size_t capacity = m_slots.empty() ? MIN_CAPACITY : m_slots.size();
+        while (probe_table_full(count, capacity)) capacity *= 2;
+        if (capacity != m_slots.size()) rehash(capacity);
+    }
+
+    void clear() {
+        m_slots.clear();
+        m_size = 0;
+    }
+
+    size_t memory_bytes() const { return m_slots.capacity() * sizeof(Slot); }
+
+private:
+    static const size_t MIN_CAPACITY = 64;
+
+    struct Slot {
+        Hash hash;
+        uint32_t index; // NONE marks an empty slot
+    };
+
+    void place(const Slot& slot) {
+        size_t mask = m_slots.size() - 1;
+        size_t i = static_cast<size_t>(slot.hash) & mask;
+        while (m_slots[i].index != NONE) i = (i + 1) & mask;
+        m_slots[i] = slot;
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> old;
+        old.swap(m_slots);
+        m_slots.assign(capacity, Slot{Hash(), NONE});
+        for (const Slot& slot : old) {
+            if (slot.index != NONE) place(slot);
+        }
+    }
+
+    std::vector<Slot> m_slots;
+    size_t m_size = 0;
+};
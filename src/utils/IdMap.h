@@ -0,0 +1,95 @@
+#pragma once
+#include "HashIndex.h"
+#include <cstdint>
+#include <vector>
+
+// Open-addressing map from a 32-bit key (typically a StringId) to a 32-bit
+// value, with linear probing and backward-shift deletion, so there are no
+// tombstones and lookups stay short after many erases.
+class IdMap {
+public:
+    static const uint32_t NONE = 0xFFFFFFFFu;
+
+    size_t size() const { return m_size; }
+
+    // Value stored for `key`, or NONE.
+    uint32_t find(uint32_t key) const {
+        if (m_slots.empty()) return NONE;
+        size_t mask = m_slots.size() - 1;
+        for (size_t i = hash(key) & mask;; i = (i + 1) & mask) {
+            const Slot& slot = m_slots[i];
+            if (slot.value == NONE) return NONE;
+            if (slot.key == key) return slot.value;
+        }
+    }
+
+    // Stores `value` (which must not be NONE) for `key`, replacing any previous value.
+    void insert(uint32_t key, uint32_t value) {
+        if (probe_table_full(m_size + 1, m_slots.size())) grow();
+        size_t mask = m_slots.size() - 1;
+        size_t i = hash(key) & mask;
+        while (m_slots[i].value != NONE && m_slots[i].key != key) i = (i + 1) & mask;
+        if (m_slots[i].value == NONE) ++m_size;
+        m_slots[i].key = key;
+        m_slots[i].value = value;
+    }
+
+    bool erase(uint32_t key) {
+        if (m_slots.empty()) return false;
+        size_t mask = m_slots.size() - 1;
+        size_t i = hash(key) & mask;
+        while (m_slots[i].key != key || m_slots[i].value == NONE) {
+            if (m_slots[i].value == NONE) return false;
+            i = (i + 1) & mask;
+        }
+        // Pull later members of the probe run back into the hole.
+        for (size_t j = (i + 1) & mask; m_slots[j].value != NONE; j = (j + 1) & mask) {
+            size_t home = hash(m_slots[j].key) & mask;
+            bool movable = (i <= j) ? (home <= i || home > j) : (home <= i && home > j);
+            if (movable) {
+                m_slots[i] = m_slots[j];
+                i = j;
+            }
+        }
+        m_slots[i].value = NONE;
+        --m_size;
+        return true;
+    }
+
+    void clear() {
+        m_slots.clear();
+        m_size = 0;
+    }
+
+    size_t memory_bytes() const { return m_slots.capacity() * sizeof(Slot); }
+
+private:
+    struct Slot {
+        uint32_t key = 0;
+        uint32_t value = NONE; // NONE marks an empty slot
+    };
+
+    // IDs are dense and often strided; mix the bits before masking.
+    static uint32_t hash(uint32_t key) {
+        key ^= key >> 16;
+        key *= 0x45d9f3bu;
+        key ^= key >> 16;
+        return key;
+    }
+
+    void grow() {
+        std::vector<Slot> old;
+        old.swap(m_slots);
+        m_slots.resize(old.empty() ? 64 : old.size() * 2);
+        size_t mask = m_slots.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.value == NONE) continue;
+            size_t i = hash(slot.key) & mask;
+            while (m_slots[i].value != NONE) i = (i + 1) & mask;
+            m_slots[i] = slot;
+        }
+    }
+
+    std::vector<Slot> m_slots;
+    size_t m_size = 0;
+};
@@ -2,6 +2,7 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <mutex>
 
 enum class LogLevel { DEBUG, INFO, WARN, ERROR, NONE };
 
@@ -48,6 +49,7 @@ public:
 private:
     Logger() = default;
     LogLevel m_level = LogLevel::INFO; // Default log level
+    std::mutex m_output_mutex;
     
     // --- C++14 COMPATIBLE RECURSIVE LOGGING ---
     template<typename T, typename... Args>
@@ -66,6 +68,8 @@ private:
         std::ostringstream oss;
         oss << prefix << " ";
         build_log_stream(oss, args...);
+        // Engine init and scans log from worker threads; keep lines whole.
+        std::lock_guard<std::mutex> lock(m_output_mutex);
         std::cout << oss.str() << std::endl;
     }
 
@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Lock-free multi-producer/single-consumer queue. Producers CAS a node onto
+// a shared list head; the consumer takes the whole list with one exchange
+// and reverses it, so each producer's items come out in the order it pushed
+// them. empty() is a single acquire load, cheap enough for every frame.
+//
+// There is no ABA problem: only the consumer removes nodes, and it always
+// removes all of them at once.
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() = default;
+    ~MpscQueue() { free_list(m_head.exchange(nullptr, std::memory_order_acquire)); }
+
+    // Any thread.
+    void push(T value) {
+        Node* node = new Node{std::move(value), m_head.load(std::memory_order_relaxed)};
+        while (!m_head.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+        }
+    }
+
+    // Consumer thread only.
+    bool empty() const { return m_head.load(std::memory_order_acquire) == nullptr; }
+
+    // Consumer thread only: pops everything queued so far into fn, oldest
+    // first. Returns how many.
+    template <typename Fn>
+    size_t drain(Fn&& fn) {
+        if (empty()) return 0;
+        Node* list = m_head.exchange(nullptr, std::memory_order_acquire);
+        Node* oldest = nullptr;
+        while (list) { // newest-first -> oldest-first
+            Node* next = list->next;
+            list->next = oldest;
+            oldest = list;
+            list = next;
+        }
+        size_t count = 0;
+        while (oldest) {
+            Node* next = oldest->next;
+            fn(std::move(oldest->value));
+            delete oldest;
+            oldest = next;
+            ++count;
+        }
+        return count;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    static void free_list(Node* node) {
+        while (node) {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    std::atomic<Node*> m_head{nullptr};
+};
@@ -0,0 +1,133 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+// Maps filesystem paths to values, one trie level per path component, so
+// "which stored path is this one under" and "what is stored below this root"
+// cost O(depth) instead of a scan over every stored path. Matching is
+// component-wise: "mod_data2/x" is not under "mod_data".
+template <typename T>
+class PathTrie {
+public:
+    PathTrie() { clear(); }
+
+    void clear() {
+        m_nodes.clear();
+        m_nodes.emplace_back();
+        m_size = 0;
+    }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    // Stores `value` at `path`, replacing any previous value there.
+    void insert(const fs::path& path, const T& value) {
+        uint32_t node = 0;
+        for (const auto& part : path) {
+            if (is_noop(part)) continue;
+            const std::string key = part.string();
+            auto it = m_nodes[node].children.find(key);
+            if (it == m_nodes[node].children.end()) {
+                uint32_t child = static_cast<uint32_t>(m_nodes.size());
+                m_nodes[node].children.emplace(key, child);
+                m_nodes.emplace_back();
+                m_nodes[child].parent = node;
+                m_nodes[child].name = key;
+                node = child;
+            } else {
+                node = it->second;
+            }
+        }
+        if (!m_nodes[node].has_value) ++m_size;
+        m_nodes[node].has_value = true;
+        m_nodes[node].value = value;
+    }
+
+    // Value stored at exactly `path`, or nullptr.
+    const T* find(const fs::path& path) const {
+        int node = find_node(path);
+        return (node >= 0 && m_nodes[node].has_value) ? &m_nodes[node].value : nullptr;
+    }
+
+    // Value of the deepest stored path that is `path` itself or one of its
+    // ancestors, or nullptr. If `owner` is given it receives that stored path.
+    const T* find_owner(const fs::path& path, fs::path* owner = nullptr) const {
+        uint32_t node = 0;
+        int best = m_nodes[0].has_value ? 0 : -1;
+        for (const auto& part : path) {
+            if (is_noop(part)) continue;
+            auto it = m_nodes[node].children.find(part.string());
+            if (it == m_nodes[node].children.end()) break;
+            node = it->second;
+            if (m_nodes[node].has_value) best = static_cast<int>(node);
+        }
+        if (best < 0) return nullptr;
+        if (owner) *owner = node_path(best);
+        return &m_nodes[best].value;
+    }
+
+    // Calls fn(path, value) for every stored path at or below `root`.
+    template <typename Fn>
+    void for_each_under(const fs::path& root, Fn&& fn) const {
+        int start = find_node(root);
+        if (start < 0) return;
+        std::vector<std::pair<uint32_t, fs::path>> stack;
+        stack.emplace_back(static_cast<uint32_t>(start), node_path(start));
+        while (!stack.empty()) {
+            auto top = std::move(stack.back());
+            stack.pop_back();
+            const Node& n = m_nodes[top.first];
+            if (n.has_value) fn(top.second, n.value);
+            for (const auto& child : n.children) stack.emplace_back(child.second, top.second / child.first);
+        }
+    }
+
+    // The deepest path that every stored path is at or below, stopping early at
+    // a stored path. Returns an empty path if the stored paths share no root.
+    fs::path common_prefix() const {
+        uint32_t node = 0;
+        while (!m_nodes[node].has_value && m_nodes[node].children.size() == 1) {
+            node = m_nodes[node].children.begin()->second;
+        }
+        return node_path(node);
+    }
+
+private:
+    struct Node {
+        std::unordered_map<std::string, uint32_t> children;
+        std::string name;
+        uint32_t parent = 0;
+        bool has_value = false;
+        T value{};
+    };
+
+    // "." shows up for trailing separators in boost paths; it names nothing.
+    static bool is_noop(const fs::path& part) { return part.empty() || part == "."; }
+
+    int find_node(const fs::path& path) const {
+        uint32_t node = 0;
+        for (const auto& part : path) {
+            if (is_noop(part)) continue;
+            auto it = m_nodes[node].children.find(part.string());
+            if (it == m_nodes[node].children.end()) return -1;
+            node = it->second;
+        }
+        return static_cast<int>(node);
+    }
+
+    fs::path node_path(int node) const {
+        std::vector<const std::string*> parts;
+        for (int n = node; n != 0; n = static_cast<int>(m_nodes[n].parent)) parts.push_back(&m_nodes[n].name);
+        fs::path result;
+        for (auto it = parts.rbegin(); it != parts.rend(); ++it) result /= **it;
+        return result;
+    }
+
+    std::vector<Node> m_nodes; // m_nodes[0] is the (empty) root
+    size_t m_size = 0;
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+// Thrown by long operations that noticed their CancelToken was cancelled.
+// Whatever they had already committed stays consistent; the rest is skipped.
+struct OperationCancelled : std::runtime_error {
+    OperationCancelled() : std::runtime_error("Operation cancelled") {}
+};
+
+// Cooperative cancellation flag, cheap to copy; copies share the flag. A
+// default-constructed token can never be cancelled, so it is the natural
+// default argument.
+class CancelToken {
+public:
+    CancelToken() = default;
+    static CancelToken make() {
+        CancelToken token;
+        token.m_flag = std::make_shared<std::atomic<bool>>(false);
+        return token;
+    }
+
+    void cancel() const {
+        if (m_flag) m_flag->store(true);
+    }
+    bool is_cancelled() const { return m_flag && m_flag->load(std::memory_order_relaxed); }
+    void throw_if_cancelled() const {
+        if (is_cancelled()) throw OperationCancelled();
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_flag;
+};
+
+// Progress of one long operation: a stage label plus a done/total counter
+// (total 0 = unknown). Written by the worker, polled by the UI every frame.
+class ProgressSink {
+public:
+    struct Snapshot {
+        std::string stage;
+        uint64_t done = 0;
+        uint64_t total = 0;
+    };
+
+    void begin(const std::string& stage, uint64_t total = 0) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stage = stage;
+        m_done = 0;
+        m_total = total;
+    }
+    void advance(uint64_t n = 1) { m_done.fetch_add(n, std::memory_order_relaxed); }
+
+    Snapshot snapshot() const {
+        Snapshot snap;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        snap.stage = m_stage;
+        snap.done = m_done.load(std::memory_order_relaxed);
+        snap.total = m_total.load(std::memory_order_relaxed);
+        return snap;
+    }
+
+private:
+    mutable std::mutex m_mutex; // guards m_stage
+    std::string m_stage;
+    std::atomic<uint64_t> m_done{0};
+    std::atomic<uint64_t> m_total{0};
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Unbounded single-producer/single-consumer queue, lock-free on both ends.
+// Used to hand worker output (log lines, progress, alerts) to the UI, which
+// drains it once per frame: neither side ever waits for the other.
+//
+// Values live in fixed-size blocks; the producer links a fresh block when
+// the current one fills, and the consumer frees blocks it has finished. T
+// must be default-constructible and movable.
+//
+// push() may only be called from one thread at a time, and pop()/drain()
+// from one (possibly different) thread at a time.
+template <typename T, size_t BlockSize = 256>
+class SpscQueue {
+public:
+    SpscQueue() : m_tail(new Block()), m_head(m_tail) {}
+    ~SpscQueue() {
+        while (m_head) {
+            Block* next = m_head->next.load(std::memory_order_relaxed);
+            delete m_head;
+            m_head = next;
+        }
+    }
+
+    // --- Producer side ---
+    void push(T value) {
+        size_t written = m_tail->written.load(std::memory_order_relaxed);
+        if (written < BlockSize) {
+            m_tail->slots[written] = std::move(value);
+            m_tail->written.store(written + 1, std::memory_order_release);
+            return;
+        }
+        Block* block = new Block();
+        block->slots[0] = std::move(value);
+        block->written.store(1, std::memory_order_relaxed);
+        m_tail->next.store(block, std::memory_order_release); // publishes the slot too
+        m_tail = block;
+    }
+
+    // --- Consumer side ---
+    bool pop(T& out) {
+        for (;;) {
+            if (m_read < m_head->written.load(std::memory_order_acquire)) {
+                out = std::move(m_head->slots[m_read++]);
+                return true;
+            }
+            if (m_read < BlockSize) return false; // producer hasn't got this far
+            Block* next = m_head->next.load(std::memory_order_acquire);
+            if (!next) return false;
+            delete m_head;
+            m_head = next;
+            m_read = 0;
+        }
+    }
+
+    // Pops everything currently queued into fn; returns how many.
+    template <typename Fn>
+    size_t drain(Fn&& fn) {
+        size_t count = 0;
+        T value;
+        while (pop(value)) {
+            fn(std::move(value));
+            ++count;
+        }
+        return count;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+private:
+    struct Block {
+        T slots[BlockSize];
+        std::atomic<size_t> written{0};
+        std::atomic<Block*> next{nullptr};
+    };
+
+    // Producer and consumer state on separate cache lines.
+    alignas(64) Block* m_tail;
+    alignas(64) Block* m_head;
+    size_t m_read = 0;
+};
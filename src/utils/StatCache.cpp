@@ -0,0 +1,56 @@
+#include "StatCache.h"
+#include "DirListing.h"
+
+StatCache& StatCache::instance() {
+    static StatCache cache;
+    return cache;
+}
+
+StatInfo StatCache::get(const fs::path& path) {
+    const std::string key = path.string();
+    auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end() && now < it->second.expires) {
+            ++m_hits;
+            return it->second.info;
+        }
+        ++m_misses;
+    }
+
+    // stat() outside the lock; a racing lookup of the same path just stats twice.
+    StatInfo info;
+    struct stat st;
+    if (stat_path(path, st)) {
+        info.exists = true;
+        info.is_directory = S_ISDIR(st.st_mode);
+        info.is_file = S_ISREG(st.st_mode);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries[key] = Entry{info, now + m_ttl};
+    return info;
+}
+
+void StatCache::invalidate(const fs::path& path) {
+    const std::string root = path.string();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        const std::string& key = it->first;
+        bool under = key.compare(0, root.size(), root) == 0 &&
+                     (key.size() == root.size() || key[root.size()] == '/' || (!root.empty() && root.back() == '/'));
+        if (under) it = m_entries.erase(it);
+        else ++it;
+    }
+}
+
+void StatCache::invalidate_all() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+void StatCache::set_ttl(std::chrono::milliseconds ttl) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ttl = ttl;
+}
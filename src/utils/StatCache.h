@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+struct StatInfo {
+    bool exists = false;
+    bool is_directory = false;
+    bool is_file = false;
+};
+
+// Process-wide cache of stat() results, so UI code can ask "does this exist"
+// every frame without touching the disk. Entries expire after a TTL as a
+// safety net; the engine invalidates paths as soon as the file watcher or its
+// own writes say they changed. Thread-safe.
+class StatCache {
+public:
+    static StatCache& instance();
+
+    StatInfo get(const fs::path& path);
+    bool exists(const fs::path& path) { return get(path).exists; }
+    bool is_directory(const fs::path& path) { return get(path).is_directory; }
+
+    // Forgets `path` and everything below it.
+    void invalidate(const fs::path& path);
+    void invalidate_all();
+
+    void set_ttl(std::chrono::milliseconds ttl);
+    uint64_t hits() const { return m_hits; }
+    uint64_t misses() const { return m_misses; }
+
+private:
+    struct Entry {
+        StatInfo info;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    std::chrono::milliseconds m_ttl{5000};
+    std::atomic<uint64_t> m_hits{0};
+    std::atomic<uint64_t> m_misses{0};
+};
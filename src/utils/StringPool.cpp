@@ -0,0 +1,53 @@
+#include "StringPool.h"
+#include <stdexcept>
+
+StringPool::StringPool() {
+    for (auto& chunk : m_chunks) chunk.store(nullptr, std::memory_order_relaxed);
+    intern(std::string());
+}
+
+StringPool::~StringPool() {
+    for (auto& chunk : m_chunks) delete[] chunk.load(std::memory_order_relaxed);
+}
+
+StringId StringPool::intern(const std::string& s) {
+    uint32_t hash = fnv1a_32(s);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint32_t existing = m_index.find(hash, [&](uint32_t id) { return str(id) == s; });
+    if (existing != HashIndex<uint32_t>::NONE) return existing;
+
+    uint32_t id = m_count.load(std::memory_order_relaxed);
+    if (id >= MAX_CHUNKS * CHUNK_SIZE) throw std::length_error("StringPool is full");
+    std::string* chunk = m_chunks[id >> CHUNK_BITS].load(std::memory_order_relaxed);
+    if (!chunk) {
+        chunk = new std::string[CHUNK_SIZE];
+        m_chunks[id >> CHUNK_BITS].store(chunk, std::memory_order_release);
+    }
+    chunk[id & (CHUNK_SIZE - 1)] = s;
+    m_string_bytes += chunk[id & (CHUNK_SIZE - 1)].capacity();
+
+    m_index.insert(hash, id);
+    m_count.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+bool StringPool::find(const std::string& s, StringId& out) const {
+    uint32_t hash = fnv1a_32(s);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint32_t existing = m_index.find(hash, [&](uint32_t id) { return str(id) == s; });
+    if (existing == HashIndex<uint32_t>::NONE) return false;
+    out = existing;
+    return true;
+}
+
+size_t StringPool::memory_bytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t chunks = (m_count.load(std::memory_order_relaxed) + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    return chunks * CHUNK_SIZE * sizeof(std::string) + m_string_bytes +
+           m_index.memory_bytes();
+}
+
+StringPool& string_pool() {
+    static StringPool pool;
+    return pool;
+}
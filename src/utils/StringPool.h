@@ -0,0 +1,60 @@
+#pragma once
+#include "HashIndex.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Dense handle for an interned string. Equal strings always get the same ID,
+// so comparing and hashing IDs replaces comparing the strings themselves.
+typedef uint32_t StringId;
+
+// Process-wide intern table for plugin names, mod names and data paths.
+// IDs are dense (0, 1, 2, ...) and never reused; ID 0 is the empty string,
+// so a default-constructed StringId is valid.
+//
+// intern() is thread-safe. str() takes no lock: strings live in fixed-size
+// chunks that never move, so any ID a thread has been handed can be read
+// while other threads keep interning.
+class StringPool {
+public:
+    static const StringId EMPTY = 0;
+
+    StringPool();
+    ~StringPool();
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    StringId intern(const std::string& s);
+    // ID of `s` if it was ever interned; returns false otherwise (and interns nothing).
+    bool find(const std::string& s, StringId& out) const;
+
+    const std::string& str(StringId id) const {
+        return m_chunks[id >> CHUNK_BITS].load(std::memory_order_acquire)[id & (CHUNK_SIZE - 1)];
+    }
+    const char* c_str(StringId id) const { return str(id).c_str(); }
+
+    size_t size() const { return m_count.load(std::memory_order_acquire); }
+    // Approximate heap use, for diagnostics.
+    size_t memory_bytes() const;
+
+private:
+    static const uint32_t CHUNK_BITS = 12;
+    static const uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+    static const uint32_t MAX_CHUNKS = 4096; // 16M strings
+
+    std::atomic<std::string*> m_chunks[MAX_CHUNKS];
+    std::atomic<uint32_t> m_count{0};
+
+    // IDs by string hash, guarded by m_mutex.
+    mutable std::mutex m_mutex;
+    HashIndex<uint32_t> m_index;
+    size_t m_string_bytes = 0;
+};
+
+// The shared pool used across the application.
+StringPool& string_pool();
+
+inline StringId intern(const std::string& s) { return string_pool().intern(s); }
+inline const std::string& interned(StringId id) { return string_pool().str(id); }
@@ -0,0 +1,306 @@
+#include "TaskScheduler.h"
+#include <algorithm>
+
+// Which scheduler and worker the current thread belongs to, if any.
+static thread_local TaskScheduler* t_scheduler = nullptr;
+static thread_local int t_worker = -1;
+// True while this thread runs a BULK task (and so holds a bulk slot).
+static thread_local bool t_holds_bulk = false;
+
+TaskScheduler::TaskScheduler(unsigned bulk_workers) {
+    bulk_workers = std::max(1u, bulk_workers);
+    m_bulk_limit = bulk_workers;
+    const unsigned worker_count = bulk_workers + 1;
+    for (unsigned i = 0; i < worker_count; ++i) m_workers.emplace_back(new Worker());
+    for (unsigned i = 0; i < worker_count; ++i) {
+        m_workers[i]->thread = std::thread(&TaskScheduler::worker_loop, this, i);
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_stop = true;
+        ++m_signal;
+    }
+    m_wake_cv.notify_all();
+    for (auto& worker : m_workers) worker->thread.join();
+}
+
+void TaskScheduler::set_bulk_limit(unsigned limit) {
+    m_bulk_limit = std::max(1u, std::min(limit, size() - 1));
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        ++m_signal;
+    }
+    m_wake_cv.notify_all();
+}
+
+// =============================================================================
+// QUEUES
+// =============================================================================
+
+void TaskScheduler::enqueue(const TaskHandle& task) {
+    // Workers push onto their own deque (cheap, cache-warm); everyone else
+    // spreads work round-robin.
+    unsigned target = (t_scheduler == this && t_worker >= 0)
+                          ? static_cast<unsigned>(t_worker)
+                          : m_next_queue.fetch_add(1) % m_workers.size();
+    {
+        std::lock_guard<std::mutex> lock(m_workers[target]->mutex);
+        m_workers[target]->queues[task->m_priority].push_back(task);
+    }
+    m_queued.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        ++m_signal;
+    }
+    m_wake_cv.notify_one();
+}
+
+TaskHandle TaskScheduler::try_take(int self, bool allow_bulk) {
+    const unsigned count = static_cast<unsigned>(m_workers.size());
+    for (int priority = INTERACTIVE; priority <= BULK; ++priority) {
+        if (priority == BULK && !allow_bulk) break;
+        // Own deque first, newest task (LIFO)...
+        if (self >= 0) {
+            Worker& own = *m_workers[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.queues[priority].empty()) {
+                TaskHandle task = std::move(own.queues[priority].back());
+                own.queues[priority].pop_back();
+                return task;
+            }
+        }
+        // ...then steal the oldest task from someone else (FIFO).
+        unsigned start = self >= 0 ? static_cast<unsigned>(self) + 1 : m_next_queue.load();
+        for (unsigned n = 0; n < count; ++n) {
+            unsigned victim = (start + n) % count;
+            if (static_cast<int>(victim) == self) continue;
+            Worker& other = *m_workers[victim];
+            std::lock_guard<std::mutex> lock(other.mutex);
+            if (!other.queues[priority].empty()) {
+                TaskHandle task = std::move(other.queues[priority].front());
+                other.queues[priority].pop_front();
+                return task;
+            }
+        }
+    }
+    return nullptr;
+}
+
+bool TaskScheduler::run_one(int self) {
+    // Reserve a bulk slot up front so two workers can't both take the last one.
+    bool reserved = false;
+    unsigned running = m_running_bulk.load();
+    while (running < m_bulk_limit.load()) {
+        if (m_running_bulk.compare_exchange_weak(running, running + 1)) {
+            reserved = true;
+            break;
+        }
+    }
+
+    TaskHandle task = try_take(self, reserved);
+    bool keep_slot = task && task->m_priority == BULK;
+    if (reserved && !keep_slot) m_running_bulk.fetch_sub(1);
+    if (!task) return false;
+
+    m_queued.fetch_sub(1);
+    run_task(task);
+    if (keep_slot) {
+        m_running_bulk.fetch_sub(1);
+        // A bulk slot opened up; idle workers may now take queued bulk work.
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            ++m_signal;
+        }
+        m_wake_cv.notify_all();
+    }
+    return true;
+}
+
+void TaskScheduler::run_task(const TaskHandle& task) {
+    bool was_bulk = t_holds_bulk;
+    t_holds_bulk = task->m_priority == BULK;
+    try {
+        task->m_fn();
+    } catch (...) {
+        task->m_error = std::current_exception();
+    }
+    t_holds_bulk = was_bulk;
+    task->m_fn = nullptr; // drop captures now, not when the last handle goes
+    finish(task);
+}
+
+void TaskScheduler::finish(const TaskHandle& task) {
+    std::vector<TaskHandle> ready;
+    std::vector<std::function<void()>> continuations;
+    {
+        std::lock_guard<std::mutex> lock(m_graph_mutex);
+        task->m_done.store(true, std::memory_order_release);
+        for (auto& dependent : task->m_dependents) {
+            if (--dependent->m_pending_deps == 0) ready.push_back(std::move(dependent));
+        }
+        task->m_dependents.clear();
+        continuations.swap(task->m_main_continuations);
+    }
+    for (const auto& dependent : ready) enqueue(dependent);
+    if (!continuations.empty()) {
+        std::lock_guard<std::mutex> lock(m_main_mutex);
+        for (auto& fn : continuations) m_main_queue.push_back(std::move(fn));
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        ++m_signal;
+    }
+    m_done_cv.notify_all();
+}
+
+void TaskScheduler::worker_loop(unsigned index) {
+    t_scheduler = this;
+    t_worker = static_cast<int>(index);
+    for (;;) {
+        uint64_t seen;
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            seen = m_signal;
+        }
+        if (run_one(static_cast<int>(index))) continue;
+
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        if (m_stop && m_queued.load() == 0) return;
+        m_wake_cv.wait(lock, [&] { return m_signal != seen; });
+    }
+}
+
+// =============================================================================
+// PUBLIC API
+// =============================================================================
+
+TaskHandle TaskScheduler::submit(std::function<void()> fn, Priority priority, const std::vector<TaskHandle>& deps) {
+    TaskHandle task = std::make_shared<Task>();
+    task->m_fn = std::move(fn);
+    task->m_priority = priority;
+    {
+        std::lock_guard<std::mutex> lock(m_graph_mutex);
+        for (const auto& dep : deps) {
+            if (!dep || dep->is_done()) continue;
+            dep->m_dependents.push_back(task);
+            ++task->m_pending_deps;
+        }
+        if (task->m_pending_deps > 0) return task;
+    }
+    enqueue(task);
+    return task;
+}
+
+void TaskScheduler::then_on_main(const TaskHandle& task, std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lock(m_graph_mutex);
+        if (task && !task->is_done()) {
+            task->m_main_continuations.push_back(std::move(fn));
+            return;
+        }
+    }
+    std::lock_guard<std::mutex> lock(m_main_mutex);
+    m_main_queue.push_back(std::move(fn));
+}
+
+void TaskScheduler::run_main_continuations() {
+    std::vector<std::function<void()>> batch;
+    {
+        std::lock_guard<std::mutex> lock(m_main_mutex);
+        batch.swap(m_main_queue);
+    }
+    for (auto& fn : batch) fn();
+}
+
+void TaskScheduler::wait(const TaskHandle& task) {
+    if (!task) return;
+    bool on_worker = t_scheduler == this && t_worker >= 0;
+    // A bulk task waiting on other work gives up its slot meanwhile, or a
+    // low bulk limit could leave nothing able to run what it waits for.
+    bool released = on_worker && t_holds_bulk;
+    if (released) m_running_bulk.fetch_sub(1);
+
+    while (!task->is_done()) {
+        uint64_t seen;
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            seen = m_signal;
+        }
+        if (task->is_done()) break;
+        if (on_worker && run_one(t_worker)) continue;
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        m_done_cv.wait(lock, [&] { return task->is_done() || m_signal != seen; });
+    }
+
+    if (released) m_running_bulk.fetch_add(1);
+}
+
+void TaskScheduler::parallel_for(size_t count, const std::function<void(size_t)>& fn, Priority priority,
+                                 unsigned width) {
+    if (count == 0) return;
+    if (count == 1) {
+        fn(0);
+        return;
+    }
+
+    // Helpers that start after the caller has finished every item find the
+    // job closed and return at once, so the caller only ever waits for
+    // helpers that are actually running; it never waits on queued ones.
+    struct Job {
+        const std::function<void(size_t)>* fn;
+        size_t count;
+        std::atomic<size_t> next{0};
+        std::mutex mutex;
+        std::condition_variable idle_cv;
+        unsigned running = 0;
+        bool closed = false;
+        std::exception_ptr error;
+
+        void run_items() {
+            for (;;) {
+                size_t i = next.fetch_add(1);
+                if (i >= count) return;
+                try {
+                    (*fn)(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error) error = std::current_exception();
+                }
+            }
+        }
+    };
+    auto job = std::make_shared<Job>();
+    job->fn = &fn;
+    job->count = count;
+
+    size_t helpers = std::min(count - 1, width ? size_t(width - 1) : m_workers.size());
+    for (size_t h = 0; h < helpers; ++h) {
+        submit([job]() {
+            {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                if (job->closed) return;
+                job->running++;
+            }
+            job->run_items();
+            {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                job->running--;
+            }
+            job->idle_cv.notify_all();
+        }, priority);
+    }
+
+    job->run_items();
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->closed = true;
+        job->idle_cv.wait(lock, [&] { return job->running == 0; });
+        error = job->error;
+    }
+    if (error) std::rethrow_exception(error);
+}
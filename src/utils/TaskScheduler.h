@@ -0,0 +1,117 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TaskScheduler;
+
+// Shared state of one submitted task. Hold a TaskHandle to wait on it or
+// chain work after it.
+class Task {
+public:
+    bool is_done() const { return m_done.load(std::memory_order_acquire); }
+    // Exception the task threw, if any (valid once done).
+    std::exception_ptr error() const { return m_error; }
+
+private:
+    friend class TaskScheduler;
+
+    std::function<void()> m_fn;
+    int m_priority = 0;
+    std::atomic<bool> m_done{false};
+    std::exception_ptr m_error;
+
+    // Guarded by TaskScheduler::m_graph_mutex.
+    unsigned m_pending_deps = 0;
+    std::vector<std::shared_ptr<Task>> m_dependents;
+    std::vector<std::function<void()>> m_main_continuations;
+};
+typedef std::shared_ptr<Task> TaskHandle;
+
+// One work-stealing thread pool for all of the engine's background work.
+//
+// Each worker owns a deque per priority: it pops its own newest task first
+// and, when idle, steals the oldest task from another worker. INTERACTIVE
+// work (things the UI is waiting on) always runs before BULK work (scans,
+// hashing, extraction, scripts). At most `bulk_limit` BULK tasks run at once,
+// and there is always at least one worker more than that, so INTERACTIVE
+// work never queues behind a script or an extraction that blocks for minutes.
+//
+// Tasks may depend on other tasks, and may schedule continuations that run
+// on the main loop (see run_main_continuations()).
+class TaskScheduler {
+public:
+    enum Priority { INTERACTIVE = 0, BULK = 1 };
+
+    // Starts bulk_workers + 1 threads, with a bulk limit of bulk_workers.
+    explicit TaskScheduler(unsigned bulk_workers);
+    // Finishes every queued task, then joins the workers.
+    ~TaskScheduler();
+
+    unsigned size() const { return static_cast<unsigned>(m_workers.size()); }
+    // Capped at size() - 1, keeping the reserved worker.
+    void set_bulk_limit(unsigned limit);
+    unsigned bulk_limit() const { return m_bulk_limit.load(); }
+
+    // Queues fn to run once every task in `deps` has finished (failed
+    // dependencies still count as finished).
+    TaskHandle submit(std::function<void()> fn, Priority priority = BULK,
+                      const std::vector<TaskHandle>& deps = {});
+    // Runs fn on the main loop once `task` has finished (immediately queued if
+    // it already has, or if `task` is null: a task handing results to the main loop).
+    void then_on_main(const TaskHandle& task, std::function<void()> fn);
+    // Runs everything then_on_main() has queued. Call from the main loop only.
+    void run_main_continuations();
+
+    // Blocks until `task` has finished. A worker thread that waits runs other
+    // queued tasks in the meantime instead of sleeping.
+    void wait(const TaskHandle& task);
+
+    // Runs fn(i) for every i in [0, count), spread over the workers, with the
+    // calling thread helping. At most `width` threads (counting the caller)
+    // work on it; 0 means as many as there are. Blocks until all calls return
+    // and rethrows the first exception. Safe to call from inside a task.
+    void parallel_for(size_t count, const std::function<void(size_t)>& fn, Priority priority = BULK,
+                      unsigned width = 0);
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<TaskHandle> queues[2]; // by Priority
+        std::thread thread;
+    };
+
+    void worker_loop(unsigned index);
+    void enqueue(const TaskHandle& task);
+    TaskHandle try_take(int self, bool allow_bulk); // self < 0: not a worker
+    void run_task(const TaskHandle& task);
+    void finish(const TaskHandle& task);
+    bool run_one(int self);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<unsigned> m_next_queue{0};
+    std::atomic<unsigned> m_running_bulk{0};
+    std::atomic<unsigned> m_bulk_limit{1};
+    std::atomic<size_t> m_queued{0};
+
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_wake_cv;
+    std::condition_variable m_done_cv;
+    uint64_t m_signal = 0; // bumped on every enqueue/finish; sleepers wait for it to move
+    bool m_stop = false;
+
+    std::mutex m_graph_mutex; // dependency edges and continuation lists
+
+    std::mutex m_main_mutex;
+    std::vector<std::function<void()>> m_main_queue;
+};
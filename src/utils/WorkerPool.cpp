@@ -0,0 +1,11 @@
+#include "WorkerPool.h"
+#include <algorithm>
+#include <thread>
+
+unsigned WorkerPool::resolve_worker_count(int requested) {
+    if (requested > 0) return static_cast<unsigned>(requested);
+    // Scans are latency-bound rather than CPU-bound, but SD cards and eMMC
+    // stop gaining much beyond a handful of outstanding requests.
+    unsigned hw = std::thread::hardware_concurrency();
+    return std::min(std::max(hw, 2u), 8u);
+}
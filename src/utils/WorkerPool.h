@@ -0,0 +1,31 @@
+#pragma once
+#include <functional>
+#include "TaskScheduler.h"
+
+// Fan-out of independent blocking work (mostly filesystem scans) onto the
+// shared TaskScheduler at a fixed priority and width. The calling thread
+// always helps; a width of 1 runs everything on it.
+class WorkerPool {
+public:
+    explicit WorkerPool(TaskScheduler& scheduler, TaskScheduler::Priority priority = TaskScheduler::BULK,
+                        unsigned width = 0)
+        : m_scheduler(scheduler), m_priority(priority), m_width(width) {}
+
+    // Picks a worker count for `requested` (0 = automatic).
+    static unsigned resolve_worker_count(int requested);
+
+    // Threads working on one parallel_for(), counting the caller.
+    unsigned size() const { return m_width ? m_width : m_scheduler.size() + 1; }
+
+    // Runs fn(i) for every i in [0, count) and blocks until all calls return.
+    // The first exception thrown by fn is rethrown here. Safe to call from
+    // inside a scheduler task.
+    void parallel_for(size_t count, const std::function<void(size_t)>& fn) {
+        m_scheduler.parallel_for(count, fn, m_priority, m_width);
+    }
+
+private:
+    TaskScheduler& m_scheduler;
+    TaskScheduler::Priority m_priority;
+    unsigned m_width; // 0 = every worker
+};